@@ -0,0 +1,36 @@
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Codificador CBOR (RFC 8949) mínimo para la telemetría: enteros de hasta
+// 32 bits, booleanos, null, texto y cabeceras de map/array. Sin floats ni
+// memoria dinámica. Si el buffer se llena el escritor queda en error y las
+// escrituras siguientes se ignoran.
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} cbor_writer_t;
+
+// Marcas de arrays de longitud indefinida
+#define CBOR_ARRAY_INDEFINITE   0x9f
+#define CBOR_BREAK              0xff
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size);
+void cbor_put_uint(cbor_writer_t *w, uint32_t value);
+void cbor_put_int(cbor_writer_t *w, int32_t value);
+void cbor_put_bool(cbor_writer_t *w, bool value);
+void cbor_put_null(cbor_writer_t *w);
+void cbor_put_text(cbor_writer_t *w, const char *text, size_t len);
+void cbor_put_map(cbor_writer_t *w, uint32_t pairs);
+void cbor_put_array(cbor_writer_t *w, uint32_t items);
+
+// Bytes escritos, o 0 si no cupo todo
+size_t cbor_writer_finish(const cbor_writer_t *w);
+
+#endif // CBOR_WRITER_H
\ No newline at end of file
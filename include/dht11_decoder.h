@@ -0,0 +1,70 @@
+#ifndef _DHT_11_DECODER
+#define _DHT_11_DECODER
+#include <stdint.h>
+#include <stddef.h>
+/**
+ * Pure DHT11 frame decoder. It has no GPIO or ESP-IDF dependencies so the
+ * same code can run on the device and on a host against recorded captures.
+*/
+
+/** Number of bits in a DHT11 frame (humidity, temperature, checksum) */
+#define DHT11_FRAME_BITS 40
+/** Pulse durations per frame: a low and a high pulse for every bit */
+#define DHT11_FRAME_PULSES (DHT11_FRAME_BITS * 2)
+/**
+ * Index of the edge where the first bit's low pulse starts in an edge capture:
+ * host release, sensor response low, sensor response high, then data.
+*/
+#define DHT11_FIRST_DATA_EDGE 3
+/**
+ * Longest pulse accepted inside a frame. A longer one means an edge was lost
+ * and two pulses were merged (nominal: 50us low, 26-28us or 70us high).
+*/
+#ifndef DHT11_PULSE_MAX_US
+#define DHT11_PULSE_MAX_US 120
+#endif
+
+typedef enum
+{
+    DHT11_DECODE_OK = 0,
+    DHT11_DECODE_TRUNCATED,     /**< fewer pulses than a full frame */
+    DHT11_DECODE_BAD_PULSE,     /**< a pulse is out of range (lost or spurious edge) */
+    DHT11_DECODE_CHECKSUM       /**< frame complete but checksum does not match */
+} dht11_decode_status_t;
+
+/**
+ * Decoded frame
+ * @var raw the five frame bytes as received
+ * @var humidity_x10 relative humidity in tenths of %
+ * @var temperature_x10 temperature in tenths of degree C
+*/
+typedef struct
+{
+    uint8_t raw[5];
+    int humidity_x10;
+    int temperature_x10;
+} dht11_frame_t;
+
+/**
+ * @brief Decodes a frame from its pulse durations
+ * @param pulses_us alternating low/high durations in microseconds, starting with the
+ *        low pulse of the first bit: {low0, high0, low1, high1, ...}
+ * @param count number of entries in pulses_us (at least DHT11_FRAME_PULSES)
+ * @param frame output, filled whenever the frame is complete (even on checksum error)
+ * @note  A bit is a 1 when its high pulse is longer than the low pulse before it,
+ *        which keeps the decoder independent of the timer resolution of the capture.
+*/
+dht11_decode_status_t dht11_decode_pulses(const uint16_t *pulses_us,size_t count,dht11_frame_t *frame);
+/**
+ * @brief Converts edge timestamps into the pulse durations expected by dht11_decode_pulses()
+ * @param edges_us timestamp of every edge, starting with the host release
+ * @param edge_count number of timestamps
+ * @param pulses_us output buffer, at least DHT11_FRAME_PULSES entries
+ * @return number of pulses written
+*/
+size_t dht11_edges_to_pulses(const uint32_t *edges_us,size_t edge_count,uint16_t *pulses_us);
+/**
+ * @brief Human readable name of a decode status
+*/
+const char *dht11_decode_status_name(dht11_decode_status_t status);
+#endif
\ No newline at end of file
@@ -19,16 +19,17 @@ typedef struct
 } dht11_t;
 /**
  * @brief Wait on pin until it reaches the specified state
+ * @note  The pin must already be configured as an input
  * @return returns either the time waited or -1 in the case of a timeout
  * @param state state to wait for
  * @param timeout if counter reaches timeout the function returns -1
 */
-int wait_for_state(dht11_t dht11,int state,int timeout);
+int wait_for_state(const dht11_t *dht11,int state,int timeout);
 /**
  * @brief Holds the pin low fo the specified duration
  * @param hold_time_us time to hold the pin low for in microseconds
 */
-void hold_low(dht11_t dht11,int hold_time_us);
+void hold_low(const dht11_t *dht11,int hold_time_us);
 /**
  * @brief The function for reading temperature and humidity values from the dht11
  * @note  This function is blocking, ie: it forces the cpu to busy wait for the duration necessary to finish comms with the sensor.
@@ -36,4 +37,23 @@ void hold_low(dht11_t dht11,int hold_time_us);
  * @param connection_timeout the number of connection attempts before declaring a timeout
 */
 int dht11_read(dht11_t *dht11,int connection_timeout);
+/**
+ * Size of the edge capture buffer. One transmission produces 85 edges: the host
+ * release, the sensor response (low and high), 40 bits (2 each), the falling edge
+ * that ends the last bit and the sensor's final release. The extra 3 slots absorb
+ * noise glitches; edges beyond the buffer are dropped.
+*/
+#define DHT11_TRANSMISSION_EDGES 85
+#define DHT11_MAX_EDGES (DHT11_TRANSMISSION_EDGES + 3)
+/**
+ * @brief Reads the dht11 capturing the sensor's edges with a GPIO interrupt
+ * @note  Non-blocking alternative to dht11_read(): the calling task sleeps during the
+ *        18 ms start pulse and the ~4 ms transmission, edges are timestamped with
+ *        esp_timer in the ISR and the pulse widths are decoded afterwards
+ *        with dht11_decode_pulses().
+ * @note  Must be called from a task. Installs the GPIO ISR service if needed.
+ * @param connection_timeout the number of read attempts before giving up
+ * @return 0 on success, -1 on timeout or checksum error
+*/
+int dht11_read_isr(dht11_t *dht11,int connection_timeout);
 #endif
\ No newline at end of file
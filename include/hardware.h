@@ -22,6 +22,40 @@ typedef enum {
     BUTTON_PRESSED = 1
 } button_state_t;
 
+// Botón por interrupción: la ISR marca cada flanco con esp_timer y lo deja
+// en una cola sin bloqueos; button_task aplica el antirrebote sobre esas
+// marcas de tiempo y genera los eventos
+#define BUTTON_DEBOUNCE_US          30000   // Ventana de rebote tras un flanco aceptado
+#define BUTTON_LONG_PRESS_MS        800
+#define BUTTON_DOUBLE_PRESS_MS      400     // Entre dos pulsaciones
+#define BUTTON_EDGE_QUEUE_LEN       32      // Potencia de 2
+#define BUTTON_TASK_PRIORITY        10
+
+typedef enum {
+    BUTTON_EVENT_PRESS = 0,
+    BUTTON_EVENT_RELEASE,
+    BUTTON_EVENT_LONG_PRESS,        // Sigue pulsado tras BUTTON_LONG_PRESS_MS
+    BUTTON_EVENT_DOUBLE_PRESS,      // Segunda pulsación dentro de BUTTON_DOUBLE_PRESS_MS
+} button_event_type_t;
+
+typedef struct {
+    button_event_type_t type;
+    int64_t time_us;                // esp_timer_get_time() del flanco
+    uint32_t duration_ms;           // RELEASE / LONG_PRESS: tiempo pulsado
+} button_event_t;
+
+// Instantánea coherente de la última lectura del DHT11
+typedef struct {
+    float temperature;
+    float humidity;
+    int16_t temperature_x10;    // Misma lectura en décimas, para formatear sin floats
+    uint16_t humidity_x10;
+    bool valid;             // false si la última lectura falló
+    int64_t timestamp_us;   // esp_timer_get_time() de la última lectura correcta
+    uint32_t sample_seq;    // Se incrementa con cada lectura correcta
+    uint32_t fail_count;    // Lecturas fallidas seguidas
+} sensor_snapshot_t;
+
 // Funciones de inicialización
 void hardware_init(void);
 
@@ -29,18 +63,30 @@ void hardware_init(void);
 void led_set(led_state_t state);
 void led_toggle(void);
 led_state_t led_get_state(void);
+uint32_t led_get_version(void);
+// Acción 0 = apagar, 1 = encender, 2 = alternar (ver led_action_from_token())
+void led_apply_action(int action);
 
-// Funciones del botón
+// Funciones del botón (estado ya filtrado de rebotes)
 button_state_t button_read(void);
 bool button_is_pressed(void);
 uint32_t button_get_press_count(void);
-
-// Función de actualización (para debounce)
-void hardware_update(void);
+uint32_t button_get_version(void);
+// Siguiente evento pendiente, sin bloquear
+bool button_get_event(button_event_t *event);
+// Aviso (desde button_task) cada vez que se encola un evento
+void button_set_listener(void (*listener)(void));
+// Flancos perdidos por cola llena (el estado se recupera igualmente)
+uint32_t button_get_dropped_edges(void);
 
 // Lecturas del sensor DHT11 (actualizadas en segundo plano)
+// Pide una lectura a dht_task; no espera a que termine
+void hardware_request_sensor_read(void);
+// Sin mutex: se puede llamar desde cualquier tarea
+void hardware_get_sensor_snapshot(sensor_snapshot_t *out);
 float hardware_get_temperature(void);
 float hardware_get_humidity(void);
 bool hardware_sensor_valid(void);
+uint32_t hardware_get_sensor_version(void);
 
 #endif // HARDWARE_H
\ No newline at end of file
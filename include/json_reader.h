@@ -0,0 +1,92 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Lector JSON incremental con memoria constante. El documento se entrega
+// por trozos del tamaño que sea (tal como llega del socket) y cada token
+// completo se pasa a un callback; un token puede quedar partido entre dos
+// trozos. No reserva memoria: el estado cabe en el propio json_reader_t.
+//
+// Las cadenas y números de más de JSON_READER_MAX_TOKEN bytes son un error,
+// igual que anidar más de JSON_READER_MAX_DEPTH niveles. Los escapes \uXXXX
+// se decodifican a UTF-8 (sin combinar pares sustitutos).
+
+#define JSON_READER_MAX_DEPTH   16
+#define JSON_READER_MAX_TOKEN   32
+
+typedef enum {
+    JSON_TOK_OBJ_BEGIN,
+    JSON_TOK_OBJ_END,
+    JSON_TOK_ARR_BEGIN,
+    JSON_TOK_ARR_END,
+    JSON_TOK_KEY,
+    JSON_TOK_STRING,
+    JSON_TOK_NUMBER,
+    JSON_TOK_TRUE,
+    JSON_TOK_FALSE,
+    JSON_TOK_NULL,
+} json_token_type_t;
+
+// depth = contenedores abiertos alrededor del token: el '{' raíz y su '}'
+// tienen 0, sus claves y valores 1. text solo vale durante el callback.
+typedef struct {
+    json_token_type_t type;
+    uint8_t depth;
+    const char *text;       // Clave, cadena o número (terminado en '\0')
+    size_t len;
+} json_token_t;
+
+// Devuelve false para abortar la lectura
+typedef bool (*json_token_fn_t)(void *ctx, const json_token_t *tok);
+
+typedef enum {
+    JSON_READER_OK,
+    JSON_READER_SYNTAX,         // Carácter inesperado
+    JSON_READER_TOO_DEEP,
+    JSON_READER_TOO_LONG,       // Cadena o número mayor que el buffer
+    JSON_READER_INCOMPLETE,     // El documento terminó a medias
+    JSON_READER_ABORTED,        // El callback devolvió false
+} json_reader_error_t;
+
+typedef struct {
+    json_token_fn_t fn;
+    void *ctx;
+    json_reader_error_t error;
+    size_t offset;              // Bytes consumidos (posición del error)
+    uint8_t depth;
+    uint16_t is_object;         // Un bit por nivel: objeto o array
+    uint8_t expect;             // Qué puede venir después (ver json_reader.c)
+    uint8_t lex;                // Token a medio leer
+    uint8_t escape;             // Progreso de un escape dentro de una cadena
+    uint16_t code;              // \uXXXX en curso
+    const char *literal;        // true/false/null en curso
+    uint8_t len;
+    char buf[JSON_READER_MAX_TOKEN + 1];
+} json_reader_t;
+
+void json_reader_init(json_reader_t *r, json_token_fn_t fn, void *ctx);
+
+// Procesa un trozo. Devuelve false en cuanto hay un error (ver r->error);
+// a partir de ahí ignora el resto.
+bool json_reader_feed(json_reader_t *r, const char *data, size_t len);
+
+// Fin del documento: true si se leyó exactamente un valor completo
+bool json_reader_finish(json_reader_t *r);
+
+const char *json_reader_error_str(json_reader_error_t error);
+
+// Convierte un token numérico a entero; false si tiene decimales,
+// exponente o no cabe en int32_t
+bool json_token_to_int(const json_token_t *tok, int32_t *out);
+
+// Acción de LED de POST /led y del comando MQTT: 0/"off", 1/"on" o
+// 2/"toggle". Devuelve la acción para led_apply_action() o -1 si no vale.
+int led_action_from_token(const json_token_t *tok);
+// Lo mismo en texto plano (payload MQTT sin JSON): "on", "off", "toggle",
+// "0", "1" o "2"
+int led_action_from_text(const char *text);
+
+#endif // JSON_READER_H
\ No newline at end of file
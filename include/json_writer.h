@@ -0,0 +1,61 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Escritor JSON en streaming sobre un buffer del llamador. No reserva
+// memoria ni usa printf: los números se formatean con aritmética entera y
+// los decimales van en punto fijo (p. ej. 235 con 1 decimal -> 23.5). Las
+// comas entre elementos se ponen solas. Si el buffer se llena el escritor
+// queda en error y json_writer_finish() devuelve 0.
+
+#define JSON_WRITER_MAX_DEPTH   16
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+    uint8_t depth;
+    uint16_t has_items;     // Un bit por nivel: ya hay un elemento escrito
+    bool after_key;         // El siguiente valor va tras "clave":
+} json_writer_t;
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+void json_obj_begin(json_writer_t *w);
+void json_obj_end(json_writer_t *w);
+void json_arr_begin(json_writer_t *w);
+void json_arr_end(json_writer_t *w);
+void json_key(json_writer_t *w, const char *key);
+
+void json_put_str(json_writer_t *w, const char *value);
+void json_put_int(json_writer_t *w, int32_t value);
+void json_put_uint(json_writer_t *w, uint32_t value);
+void json_put_int64(json_writer_t *w, int64_t value);
+void json_put_fixed(json_writer_t *w, int32_t value, uint8_t decimals);
+void json_put_bool(json_writer_t *w, bool value);
+void json_put_null(json_writer_t *w);
+
+// Atajos clave + valor
+void json_kv_str(json_writer_t *w, const char *key, const char *value);
+void json_kv_int(json_writer_t *w, const char *key, int32_t value);
+void json_kv_uint(json_writer_t *w, const char *key, uint32_t value);
+void json_kv_fixed(json_writer_t *w, const char *key, int32_t value, uint8_t decimals);
+void json_kv_bool(json_writer_t *w, const char *key, bool value);
+
+// Vacía el buffer conservando el anidamiento, para enviar un documento
+// grande por trozos (respuestas chunked)
+void json_writer_reset_buffer(json_writer_t *w);
+
+// Longitud sin contar el '\0' final, o 0 si no cupo todo
+size_t json_writer_finish(json_writer_t *w);
+
+#ifdef JSON_WRITER_BENCHMARK
+// Compara ciclos de CPU por serialización frente a snprintf con %.1f
+void json_writer_benchmark(void);
+#endif
+
+#endif // JSON_WRITER_H
\ No newline at end of file
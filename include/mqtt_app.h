@@ -0,0 +1,91 @@
+#ifndef MQTT_APP_H
+#define MQTT_APP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_inflight.h"
+
+// Configuración del broker
+#define MQTT_BROKER_HOST            "37.27.243.58"
+#define MQTT_BROKER_PORT            1883
+#define MQTT_CLIENT_ID              "ESP32C3_CLIENT"
+#define MQTT_OUTBOX_LIMIT_BYTES     8192    // Tope del outbox de esp-mqtt
+
+// Tópicos
+#define MQTT_TOPIC_TELEMETRY        "test/server"
+#define MQTT_TOPIC_BACKLOG          "test/server/backlog"   // Muestras guardadas sin conexión
+#define MQTT_TOPIC_CMD              "test/server/cmd"
+#define MQTT_TOPIC_CMD_FILTER       MQTT_TOPIC_CMD "/#"     // Única suscripción de comandos
+#define MQTT_TOPIC_CMD_LED          MQTT_TOPIC_CMD "/led"
+#define MQTT_TOPIC_CMD_CONFIG       MQTT_TOPIC_CMD "/config"
+#define MQTT_TOPIC_CMD_HISTORY      MQTT_TOPIC_CMD "/history"
+#define MQTT_TOPIC_RESP             "test/server/resp"      // Respuestas con el "id" del comando
+
+// Lotes de publicación. Cada tópico acumula muestras y las envía juntas
+// como un array (JSON o CBOR, según mqtt_format_t) al llegar a N muestras
+// o T ms desde la primera.
+#define MQTT_BATCH_MAX_SAMPLES      16      // Límite duro de muestras por lote
+#define MQTT_BATCH_BUF_BYTES        2048    // Tamaño máximo de un lote
+#define MQTT_TELEMETRY_BATCH_SAMPLES 12     // 12 × 5 s = un mensaje por minuto
+#define MQTT_TELEMETRY_BATCH_MAX_MS 60000
+
+typedef enum {
+    MQTT_BATCH_TELEMETRY = 0,
+    MQTT_BATCH_COUNT
+} mqtt_batch_id_t;
+
+// Codificación de las muestras de cada tópico. Un lote JSON es un array
+// "[...]"; un lote CBOR es un array de longitud indefinida (0x9f ... 0xff).
+typedef enum {
+    MQTT_FORMAT_JSON = 0,
+    MQTT_FORMAT_CBOR,
+    MQTT_FORMAT_COUNT
+} mqtt_format_t;
+
+// JSON por defecto para no romper a los suscriptores actuales de
+// MQTT_TOPIC_TELEMETRY; MQTT_FORMAT_CBOR es opcional y exige que todos los
+// consumidores del tópico lo decodifiquen (tools/telemetry_decode.py)
+#define MQTT_TELEMETRY_FORMAT       MQTT_FORMAT_JSON
+
+// Recuperación de la cola persistente al reconectar
+#define MQTT_BACKLOG_BATCH_BYTES    1024    // Tamaño máximo de un lote (array JSON o CBOR)
+#define MQTT_BACKLOG_INTERVAL_MS    250     // Como mucho un lote cada intervalo
+#define MQTT_BACKLOG_ACK_TIMEOUT_MS 10000   // Sin PUBACK se reenvía el lote
+
+// Funciones MQTT
+void mqtt_app_start(void);
+bool mqtt_app_is_connected(void);
+
+// Respuesta a un comando: QoS 1, sin lotes y con prioridad sobre la
+// telemetría en el cupo de mensajes en vuelo. Devuelve el msg_id o -1.
+int mqtt_app_publish_response(const char *topic, const char *data, size_t len);
+
+// Estado de la cola de salida, para diagnóstico (/status)
+typedef struct {
+    bool connected;
+    mqtt_inflight_stats_t inflight;
+    uint32_t outbox_bytes;      // Tamaño real del outbox de esp-mqtt
+    uint32_t deferred;          // Lotes desviados a flash por falta de cupo
+    uint32_t dropped;           // Muestras perdidas (cola llena, sin persistencia o expiradas)
+    uint32_t backlog_pending;   // Muestras en la cola persistente
+} mqtt_app_stats_t;
+
+void mqtt_app_get_stats(mqtt_app_stats_t *out);
+
+// Formato en que el tópico espera sus muestras
+mqtt_format_t mqtt_app_get_format(mqtt_batch_id_t batch);
+
+// Añade una muestra (objeto JSON o map CBOR con su propio "ts", según el
+// formato del tópico) al lote. urgent envía el lote en el acto, p. ej. ante
+// un cambio de estado. Sin conexión las muestras de telemetría se guardan
+// en flash y se reenvían después en MQTT_TOPIC_BACKLOG.
+void mqtt_app_publish_sample(mqtt_batch_id_t batch, const void *data, size_t len, bool urgent);
+void mqtt_app_flush(mqtt_batch_id_t batch);
+
+// Cierra los lotes por tiempo y envía la cola pendiente; llamar
+// periódicamente. Devuelve true mientras se está vaciando la cola: conviene
+// volver a llamar tras MQTT_BACKLOG_INTERVAL_MS.
+bool mqtt_app_poll(void);
+
+#endif // MQTT_APP_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef MQTT_COMMANDS_H
+#define MQTT_COMMANDS_H
+
+// Comandos remotos por MQTT (tópicos en mqtt_app.h):
+//   MQTT_TOPIC_CMD_LED     {"id":"42","action":"on"|"off"|"toggle"|0|1|2}
+//                          o simplemente on / off / toggle / 0 / 1 / 2
+//   MQTT_TOPIC_CMD_CONFIG  {"id":"43","heartbeat_s":60,"temp_deadband":5,"humidity_deadband":20}
+//                          (en décimas; los campos ausentes no cambian)
+//   MQTT_TOPIC_CMD_HISTORY {"id":"44","tier":"raw"|"1m"|"15m","from":0,"to":3600,"limit":24}
+//                          (todo opcional; igual que GET /history pero como
+//                          mucho MQTT_CMD_HISTORY_MAX_POINTS puntos por
+//                          respuesta: si hay más, "next" es el "from" de la
+//                          siguiente página)
+// El payload JSON se valida entero con json_reader: debe ser un objeto bien
+// formado y solo cuentan sus claves de primer nivel. "action" admite lo
+// mismo que POST /led (led_action_from_token).
+// Cada comando responde en MQTT_TOPIC_RESP con el mismo "id", "ok" y el
+// estado resultante, o "error" si no se pudo aplicar.
+
+#define MQTT_CMD_ID_MAX     32
+#define MQTT_CMD_HISTORY_MAX_POINTS     24      // ~40 bytes por punto
+
+// Registra los handlers en mqtt_router; llamar antes de conectar
+void mqtt_commands_init(void);
+
+#endif // MQTT_COMMANDS_H
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef MQTT_INFLIGHT_H
+#define MQTT_INFLIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+// Seguimiento de publicaciones QoS 1 pendientes de PUBACK, por msg_id.
+// Limita cuántos mensajes y bytes puede haber en vuelo (y por tanto en el
+// outbox de esp-mqtt, que vive en el heap) y reparte ese cupo por clases:
+// las respuestas a comandos pueden usarlo entero, la telemetría una parte y
+// la recuperación del backlog menos aún. Así un broker lento no hace crecer
+// la memoria sin límite y los comandos siguen respondiendo.
+
+#define MQTT_INFLIGHT_MAX           8       // Mensajes sin PUBACK
+#define MQTT_INFLIGHT_MAX_BYTES     6144    // Bytes sin PUBACK
+
+// esp-mqtt retira del outbox lo que lleva este tiempo sin PUBACK y lo
+// notifica con MQTT_EVENT_DELETED
+#ifdef CONFIG_MQTT_OUTBOX_EXPIRED_TIMEOUT_MS
+#define MQTT_OUTBOX_EXPIRED_MS      CONFIG_MQTT_OUTBOX_EXPIRED_TIMEOUT_MS
+#else
+#define MQTT_OUTBOX_EXPIRED_MS      30000   // Valor por defecto de esp-mqtt
+#endif
+
+// Red de seguridad por si no llega el evento. Debe superar la expiración
+// del outbox: liberar antes el cupo admitiría lotes nuevos con el outbox
+// aún lleno
+#define MQTT_INFLIGHT_TIMEOUT_MS    (MQTT_OUTBOX_EXPIRED_MS + 5000)
+
+typedef enum {
+    MQTT_CLASS_COMMAND = 0,     // Respuestas a comandos (máxima prioridad)
+    MQTT_CLASS_TELEMETRY,
+    MQTT_CLASS_BACKLOG,
+    MQTT_CLASS_COUNT
+} mqtt_class_t;
+
+typedef struct {
+    uint32_t inflight;
+    uint32_t inflight_bytes;
+    uint32_t max_inflight;          // Máximo observado
+    uint32_t acked;
+    uint32_t puback_last_ms;
+    uint32_t puback_avg_ms;         // Media móvil (1/8)
+    uint32_t puback_max_ms;
+    uint32_t timeouts;              // Sin PUBACK tras MQTT_INFLIGHT_TIMEOUT_MS
+    uint32_t expired;               // Descartados por esp-mqtt (MQTT_EVENT_DELETED)
+    uint32_t lost_samples;          // Muestras de los mensajes expirados o sin PUBACK
+    uint32_t rejected[MQTT_CLASS_COUNT];   // No admitidos por falta de cupo
+} mqtt_inflight_stats_t;
+
+// Funciones del seguimiento
+// Reserva hueco y bytes para un mensaje de esta clase, de forma atómica
+// para que dos tareas que publican no superen juntas el cupo. Devuelve la
+// reserva o -1 si no cabe. Tras publicar, mqtt_inflight_track() la asocia
+// al msg_id; si la publicación falla o no espera PUBACK (QoS 0),
+// mqtt_inflight_cancel() la libera. samples son las muestras que solo
+// existen en este mensaje: si expira sin PUBACK se suman a lost_samples.
+int mqtt_inflight_admit(mqtt_class_t cls, size_t bytes, uint16_t samples);
+void mqtt_inflight_track(int slot, int msg_id);
+void mqtt_inflight_cancel(int slot);
+void mqtt_inflight_ack(int msg_id);
+void mqtt_inflight_expire_msg(int msg_id);
+void mqtt_inflight_expire_old(void);
+void mqtt_inflight_get_stats(mqtt_inflight_stats_t *out);
+
+#endif // MQTT_INFLIGHT_H
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef MQTT_ROUTER_H
+#define MQTT_ROUTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Despacho de mensajes MQTT entrantes por tópico. Los patrones admiten los
+// comodines de MQTT ('+' un nivel, '#' el resto, también cero niveles) y se
+// compilan en un trie por niveles al registrarlos, así el coste de despachar
+// depende de la profundidad del tópico y no del número de rutas. Los
+// mensajes que esp-mqtt entrega en varios trozos se reensamblan antes de
+// llamar al handler.
+
+#define MQTT_ROUTER_MAX_ROUTES      8
+#define MQTT_ROUTER_MAX_NODES       24      // Niveles distintos entre todos los patrones
+#define MQTT_ROUTER_MAX_TOPIC       128
+#define MQTT_ROUTER_MAX_PAYLOAD     1024
+
+// payload siempre termina en '\0' (no cuenta en len)
+typedef void (*mqtt_route_handler_t)(const char *topic, const char *payload, size_t len, void *ctx);
+
+// Funciones del router
+// fallback: solo se llama si ninguna otra ruta coincide
+esp_err_t mqtt_router_add(const char *pattern, mqtt_route_handler_t handler, void *ctx, bool fallback);
+
+// Entrada desde MQTT_EVENT_DATA (campos del evento tal cual)
+void mqtt_router_feed(const char *topic, int topic_len, const char *data, int data_len,
+                      int offset, int total_len);
+
+// Despacha un mensaje completo; devuelve el número de handlers llamados
+int mqtt_router_dispatch(const char *topic, const char *payload, size_t len);
+
+#endif // MQTT_ROUTER_H
\ No newline at end of file
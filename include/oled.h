@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "esp_err.h"
 #include "fonts.h"
 #include "hardware.h"
 
@@ -18,6 +19,15 @@
 #define SCREEN_HEIGHT               40
 #define X_OFFSET                    28
 #define Y_OFFSET                    12
+#define OLED_PAGES                  (SCREEN_HEIGHT / 8)
+
+// Lote de comandos SSD1306 enviados en una sola transacción I2C
+#define OLED_CMD_BATCH_MAX          32
+
+typedef struct {
+    uint8_t cmds[OLED_CMD_BATCH_MAX];
+    size_t len;
+} oled_cmd_batch_t;
 
 // Funciones de inicialización
 void oled_init(void);
@@ -25,12 +35,22 @@ void i2c_master_init(void);
 
 // Funciones de control básico
 void oled_clear(void);
-void oled_update(void);
+void oled_update(void);              // No bloqueante: presenta el fotograma
 void oled_set_power(int on);
+// Fotogramas presentados con oled_update() y cuántos se fusionaron con uno
+// que la tarea de pantalla aún no había enviado
+void oled_get_frame_stats(uint32_t *presented, uint32_t *coalesced);
+
+// Envío agrupado de comandos (begin/append/commit)
+void oled_cmd_begin(oled_cmd_batch_t *batch);
+void oled_cmd_append(oled_cmd_batch_t *batch, uint8_t cmd);
+esp_err_t oled_cmd_commit(oled_cmd_batch_t *batch);
 
 // Funciones de dibujo
 void oled_draw_pixel(int x, int y);
 void oled_draw_line(int x0, int y0, int x1, int y1);
+void oled_draw_hline(int x, int y, int w);
+void oled_draw_vline(int x, int y, int h);
 void oled_draw_rect(int x, int y, int w, int h);
 void oled_draw_fill_rect(int x, int y, int w, int h);
 
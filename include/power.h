@@ -0,0 +1,31 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Modo de bajo consumo: escalado de frecuencia y light sleep automático
+// (esp_pm + tickless idle). El chip duerme cuando ninguna tarea tiene
+// trabajo; lo despiertan el esp_timer del planificador, el WiFi (modem
+// sleep, ver WIFI_POWER_SAVE) y el botón. Requiere CONFIG_PM_ENABLE.
+
+#define POWER_MAX_CPU_FREQ_MHZ      160
+#define POWER_MIN_CPU_FREQ_MHZ      40      // XTAL
+#define POWER_LIGHT_SLEEP           1       // 0 = solo escalado de frecuencia
+#define POWER_STATS_PERIOD_MS       60000   // Ventana de las medidas por minuto
+
+typedef struct {
+    bool light_sleep;               // Light sleep automático activo
+    uint32_t sleeps;                // Veces que se entró en light sleep
+    uint64_t sleep_us;              // Tiempo total dormido
+    uint32_t wakeups_per_min;       // Última ventana completa
+    uint32_t sleep_permille;        // Fracción de la última ventana dormida (‰)
+} power_stats_t;
+
+void power_init(void);
+
+// Cierra la ventana de medida; llamar cada POWER_STATS_PERIOD_MS
+void power_update(void);
+void power_get_stats(power_stats_t *out);
+
+#endif // POWER_H
\ No newline at end of file
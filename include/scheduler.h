@@ -0,0 +1,57 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Planificador de trabajos periódicos y puntuales sobre una rueda de
+// temporizadores jerárquica. Un único esp_timer se arma para el siguiente
+// vencimiento y la tarea que llama a scheduler_run() duerme hasta entonces:
+// no hay despertares en vacío. Los trabajos se ejecutan en esa tarea, uno
+// detrás de otro, así que no deben bloquear.
+//
+// Los periodos se miden sobre una rejilla común que empieza en
+// scheduler_init(); la fase desplaza cada trabajo dentro de su periodo para
+// que no coincidan varios en el mismo instante.
+
+#define SCHEDULER_MAX_JOBS          12
+#define SCHEDULER_TICK_US           1000    // Resolución de la rueda
+#define SCHEDULER_MAX_DELAY_MS      3600000 // Mayor periodo o retraso admitido
+
+typedef void (*scheduler_fn_t)(void *ctx);
+
+// Medidas de un trabajo. El retraso es lo que tardó en empezar respecto al
+// instante previsto (jitter); el plazo es el retraso máximo tolerado.
+typedef struct {
+    const char *name;
+    uint32_t runs;
+    uint32_t deadline_misses;       // Empezó con más retraso que su plazo
+    uint32_t skipped;               // Periodos saltados por ir con retraso
+    uint32_t max_late_us;
+    uint32_t avg_late_us;
+    uint32_t max_run_us;            // Duración de la ejecución más larga
+} scheduler_job_stats_t;
+
+void scheduler_init(void);
+
+// Trabajo periódico: primera ejecución en la fase indicada de la rejilla.
+// deadline_ms = 0 si no tiene plazo. Devuelve su id o -1.
+int scheduler_add_periodic(const char *name, scheduler_fn_t fn, void *ctx,
+                           uint32_t period_ms, uint32_t phase_ms, uint32_t deadline_ms);
+
+// Trabajo puntual: queda registrado sin armar hasta scheduler_run_in()
+int scheduler_add_oneshot(const char *name, scheduler_fn_t fn, void *ctx, uint32_t deadline_ms);
+
+// Ejecuta el trabajo dentro de delay_ms (0 = en cuanto se pueda). Si ya
+// tenía una ejecución antes se mantiene esa; un periódico conserva su
+// rejilla. Se puede llamar desde cualquier tarea (no desde una ISR).
+void scheduler_run_in(int job, uint32_t delay_ms);
+
+// Bucle del planificador en la tarea que lo llama; no retorna
+void scheduler_run(void);
+
+bool scheduler_get_stats(int job, scheduler_job_stats_t *out);
+int scheduler_job_count(void);
+void scheduler_log_stats(void);
+
+#endif // SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Capacidad de cada nivel (muestras DHT11 cada 5 s)
+#define SENSOR_HISTORY_RAW_LEN      720     // 1 h de muestras crudas
+#define SENSOR_HISTORY_1M_LEN       360     // 6 h de resúmenes por minuto
+#define SENSOR_HISTORY_15M_LEN      192     // 48 h de resúmenes cada 15 minutos
+
+// Niveles de resolución
+typedef enum {
+    SENSOR_TIER_RAW = 0,
+    SENSOR_TIER_1MIN,
+    SENSOR_TIER_15MIN,
+    SENSOR_TIER_COUNT
+} sensor_tier_t;
+
+// Muestra cruda (valores en décimas: 23.4 °C -> 234)
+typedef struct {
+    uint32_t time_s;            // Segundos desde el arranque (esp_timer)
+    int16_t temperature_x10;
+    uint16_t humidity_x10;
+} sensor_sample_t;
+
+// Resumen de un intervalo; las muestras crudas se devuelven con min = max = avg
+typedef struct {
+    uint32_t start_s;
+    int16_t temp_min_x10;
+    int16_t temp_max_x10;
+    int16_t temp_avg_x10;
+    uint16_t hum_min_x10;
+    uint16_t hum_max_x10;
+    uint16_t hum_avg_x10;
+} sensor_rollup_t;
+
+// Acumulador del intervalo abierto de cada nivel de resumen
+typedef struct {
+    uint32_t start_s;
+    int32_t temp_sum;
+    uint32_t hum_sum;
+    int16_t temp_min_x10;
+    int16_t temp_max_x10;
+    uint16_t hum_min_x10;
+    uint16_t hum_max_x10;
+    uint16_t count;
+} sensor_rollup_acc_t;
+
+// Posición de un buffer circular
+typedef struct {
+    uint16_t head;              // Próxima posición a escribir
+    uint16_t count;
+} sensor_ring_t;
+
+// Memoria total del almacén (comprobada con _Static_assert en sensor_history.c)
+#define SENSOR_HISTORY_MEMORY_BYTES \
+    (SENSOR_HISTORY_RAW_LEN * sizeof(sensor_sample_t) + \
+     (SENSOR_HISTORY_1M_LEN + SENSOR_HISTORY_15M_LEN) * sizeof(sensor_rollup_t) + \
+     (SENSOR_TIER_COUNT - 1) * sizeof(sensor_rollup_acc_t) + \
+     SENSOR_TIER_COUNT * sizeof(sensor_ring_t))
+
+// Funciones del histórico
+void sensor_history_init(void);
+void sensor_history_add(uint32_t time_s, int16_t temperature_x10, uint16_t humidity_x10);
+
+// Copia en 'out' los puntos del nivel con inicio en [from_s, to_s], del más
+// antiguo al más reciente. Devuelve el número de puntos copiados; para
+// paginar, repetir con from_s = último start_s + 1.
+size_t sensor_history_query(sensor_tier_t tier, uint32_t from_s, uint32_t to_s,
+                            sensor_rollup_t *out, size_t max_points);
+
+// Periodo en segundos de cada punto del nivel
+uint32_t sensor_history_tier_period(sensor_tier_t tier);
+const char* sensor_history_tier_name(sensor_tier_t tier);
+
+#endif // SENSOR_HISTORY_H
\ No newline at end of file
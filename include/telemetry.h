@@ -0,0 +1,54 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// Publicación por cambio. Cada campo tiene una banda muerta: si el valor se
+// aleja del último publicado más que su banda se emite una muestra en el
+// acto. Si nada cambia solo se envía un latido cada TELEMETRY_HEARTBEAT_MS.
+
+#define TELEMETRY_HEARTBEAT_MS          300000  // Latido en reposo (5 min)
+#define TELEMETRY_TEMP_DEADBAND_X10     5       // 0.5 °C
+#define TELEMETRY_HUMIDITY_DEADBAND_X10 20      // 2.0 %
+
+// Límites de los valores configurables en tiempo de ejecución
+#define TELEMETRY_HEARTBEAT_MIN_MS      10000
+#define TELEMETRY_HEARTBEAT_MAX_MS      3600000
+#define TELEMETRY_DEADBAND_MAX_X10      500
+#define TELEMETRY_SAMPLE_MAX            192     // Bytes de una muestra (JSON o CBOR)
+
+// Claves enteras de cada muestra en modo CBOR (ver tools/telemetry_decode.py).
+// Temperatura y humedad van en décimas (punto fijo). reason lleva la clave
+// del campo que cambió o TELEMETRY_REASON_HEARTBEAT.
+typedef enum {
+    TELEMETRY_KEY_TS = 0,
+    TELEMETRY_KEY_LED = 1,
+    TELEMETRY_KEY_BUTTON = 2,
+    TELEMETRY_KEY_PRESSES = 3,
+    TELEMETRY_KEY_TEMPERATURE = 4,
+    TELEMETRY_KEY_HUMIDITY = 5,
+    TELEMETRY_KEY_SENSOR_VALID = 6,
+    TELEMETRY_KEY_SEQ = 7,
+    TELEMETRY_KEY_REASON = 8,
+} telemetry_key_t;
+
+#define TELEMETRY_REASON_HEARTBEAT      (-1)
+
+// Parámetros ajustables (p. ej. por comando MQTT)
+typedef struct {
+    uint32_t heartbeat_ms;
+    int32_t temp_deadband_x10;
+    int32_t humidity_deadband_x10;
+} telemetry_config_t;
+
+// Funciones de telemetría
+// Llamar desde el bucle principal; compara el estado actual con el último
+// publicado y entrega la muestra a mqtt_app si hace falta
+void telemetry_poll(void);
+uint32_t telemetry_get_sent_count(void);
+void telemetry_get_config(telemetry_config_t *out);
+// ESP_ERR_INVALID_ARG si algún valor está fuera de rango (no se aplica nada)
+esp_err_t telemetry_set_config(const telemetry_config_t *config);
+
+#endif // TELEMETRY_H
\ No newline at end of file
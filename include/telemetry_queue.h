@@ -0,0 +1,48 @@
+#ifndef TELEMETRY_QUEUE_H
+#define TELEMETRY_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// Cola persistente (append-only) de telemetría en la partición "telemetry".
+// Guarda las muestras mientras no hay conexión MQTT y las entrega en orden
+// al reconectar. La partición se usa como anillo de segmentos de 4 KB: solo
+// se borra un segmento cuando el escritor lo necesita, así que el desgaste se
+// reparte por igual. Si la cola se llena se descarta el segmento más antiguo.
+
+#define TELEMETRY_QUEUE_PARTITION       "telemetry"
+#define TELEMETRY_QUEUE_SUBTYPE         0x40
+#define TELEMETRY_QUEUE_MAX_RECORD      512     // Bytes de carga por registro
+
+// Posición de lectura. Se obtiene con telemetry_queue_cursor_init(), avanza
+// con cada telemetry_queue_read() y se confirma con telemetry_queue_consume().
+typedef struct {
+    uint16_t segment;
+    uint32_t offset;
+    uint32_t records;       // Registros recorridos desde el inicio del cursor
+    uint32_t skipped;       // De ellos, descartados sin devolver (corruptos)
+    uint32_t generation;    // Detecta si se descartaron datos mientras tanto
+} telemetry_queue_cursor_t;
+
+typedef struct {
+    uint32_t pending;       // Registros sin confirmar
+    uint32_t dropped;       // Registros perdidos por cola llena
+    uint32_t segments;
+    uint32_t max_erase_count;
+} telemetry_queue_stats_t;
+
+// Funciones de la cola
+esp_err_t telemetry_queue_init(void);
+esp_err_t telemetry_queue_push(const void *data, size_t len);
+
+void telemetry_queue_cursor_init(telemetry_queue_cursor_t *cursor);
+// ESP_ERR_NOT_FOUND cuando no quedan registros
+esp_err_t telemetry_queue_read(telemetry_queue_cursor_t *cursor, void *buf, size_t buf_len, size_t *out_len);
+// Marca como entregados todos los registros anteriores al cursor
+esp_err_t telemetry_queue_consume(const telemetry_queue_cursor_t *cursor);
+
+uint32_t telemetry_queue_pending(void);
+void telemetry_queue_get_stats(telemetry_queue_stats_t *stats);
+
+#endif // TELEMETRY_QUEUE_H
\ No newline at end of file
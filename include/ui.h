@@ -0,0 +1,49 @@
+#ifndef UI_H
+#define UI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware.h"
+
+// Intervalo mínimo entre dos renders de pantalla (tope de refresco)
+#define UI_MIN_REFRESH_MS           100
+
+// Valores de estado de los que puede depender una pantalla
+typedef enum {
+    UI_BIND_LED         = 1 << 0,
+    UI_BIND_BUTTON      = 1 << 1,
+    UI_BIND_PRESS_COUNT = 1 << 2,
+    UI_BIND_SENSOR      = 1 << 3,
+    UI_BIND_NETWORK     = 1 << 4,   // IP y RSSI
+} ui_binding_t;
+
+// Instantánea del estado que recibe la función de render
+typedef struct {
+    led_state_t led_state;
+    button_state_t button_state;
+    uint32_t press_count;
+    float temperature;
+    float humidity;
+    bool sensor_valid;
+    const char *ip;
+    int rssi;
+} ui_state_t;
+
+// Pantalla en modo retenido: declara sus dependencias y cómo dibujarse
+typedef struct {
+    const char *name;
+    uint32_t bindings;                          // Máscara de ui_binding_t
+    void (*render)(const ui_state_t *state);
+} ui_screen_t;
+
+// Pantallas disponibles
+extern const ui_screen_t UI_SCREEN_BUTTON_DEBUG;
+extern const ui_screen_t UI_SCREEN_COMBINED_STATUS;
+
+// Funciones de la UI
+void ui_set_screen(const ui_screen_t *screen);
+void ui_invalidate(void);
+bool ui_poll(void);
+bool ui_is_dirty(void);
+
+#endif // UI_H
\ No newline at end of file
@@ -4,9 +4,46 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// La página se revalida en cada carga: con el ETag solo cuesta un 304 sin
+// cuerpo y tras actualizar el firmware se ve la nueva al momento
+#define WEB_INDEX_CACHE_CONTROL     "no-cache"
+#define WEB_STATUS_MAX_LEN          768     // Documento de /status
+
+// El documento de /status se cachea y solo se regenera si cambia alguna
+// entrada. Las métricas (MQTT, bajo consumo) se muestrean con este periodo.
+#define WEB_STATUS_METRICS_MS       5000
+
+// Trabajadores para las rutas con envíos largos (/ y /history). Tienen
+// menos prioridad que la tarea de httpd, que atiende /led y /status sin
+// esperar a los clientes lentos.
+#define WEB_WORKER_COUNT            2
+#define WEB_WORKER_QUEUE_LEN        4       // Con la cola llena se responde 503
+#define WEB_WORKER_STACK_SIZE       4096
+#define WEB_WORKER_PRIORITY         4       // httpd usa 5
+
+// GET /history: los puntos se acumulan en un trozo y se envía cuando no
+// cabe otro en el peor caso (",[4294967295,-32768,...,65535]" = 53 bytes)
+#define WEB_HISTORY_CHUNK           512
+#define WEB_HISTORY_POINT_MAX       56
+
+// POST /led: acción suelta o secuencia de acciones con esperas
+#define WEB_LED_MAX_BODY            1024
+#define WEB_LED_RECV_CHUNK          64      // Lectura del cuerpo por trozos
+#define WEB_LED_MAX_ACTIONS         8
+#define WEB_LED_MAX_DELAY_MS        10000   // Espera máxima entre dos pasos
+
+// Push del estado por WebSocket (/ws): cada cambio se serializa una vez y
+// se envía a todos los paneles abiertos, que así no necesitan sondear
+#define WEB_WS_MAX_CLIENTS          4
+#define WEB_WS_REFRESH_MS           10000   // Revisión de métricas; solo se envía si cambió
+
 // Funciones del servidor web
 void web_server_start(void);
 void web_server_stop(void);
+// Empuja el estado a /ws si cambió o toca refresco; barato si no hay nada
+// que hacer. Se puede llamar desde cualquier tarea.
+void web_server_push_changes(void);
+void web_server_log_stats(void);
 
 // Estructura para el estado del sistema
 typedef struct {
@@ -16,7 +53,10 @@ typedef struct {
     char* ip_address;
     float temperature;
     float humidity;
+    int16_t temperature_x10;
+    uint16_t humidity_x10;
     bool sensor_valid;
+    uint32_t sensor_seq;
 } system_status_t;
 
 // Función para obtener el estado del sistema
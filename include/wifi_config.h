@@ -2,16 +2,28 @@
 #define WIFI_CONFIG_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 // Configuración WiFi (usando tu código que funciona)
 #define WIFI_SSID      "Sukuna-78-2.4g"
 #define WIFI_PASSWORD  "gMigbert.78"
 #define WIFI_MAX_RETRY 15
 
+// Modem sleep: la radio se apaga entre beacons y solo despierta para
+// escuchar cada WIFI_LISTEN_INTERVAL beacons (conviene un múltiplo del DTIM
+// del AP). Cada petición entrante puede tardar ese intervalo en llegar.
+#define WIFI_POWER_SAVE         WIFI_PS_MAX_MODEM
+#define WIFI_LISTEN_INTERVAL    3
+
+// El RSSI se muestrea a baja frecuencia (es una llamada al driver)
+#define WIFI_RSSI_SAMPLE_MS     5000
+
 // Funciones WiFi
 bool wifi_init(void);
 bool wifi_is_connected(void);
 char* wifi_get_ip(void);
-int wifi_get_rssi(void);
+int wifi_get_rssi(void);           // Último muestreo, sin llamar al driver
+void wifi_refresh_rssi(void);
+uint32_t wifi_get_version(void);   // Cambia al conectar/desconectar, de IP o de RSSI
 
 #endif // WIFI_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "cbor_writer.h"
+#include <string.h>
+
+// Tipos mayores de CBOR (3 bits altos del byte inicial)
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NEGINT   1
+#define CBOR_MAJOR_TEXT     3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
+#define CBOR_MAJOR_SIMPLE   7
+
+#define CBOR_SIMPLE_FALSE   20
+#define CBOR_SIMPLE_TRUE    21
+#define CBOR_SIMPLE_NULL    22
+
+void cbor_writer_init(cbor_writer_t *w, uint8_t *buf, size_t size)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->overflow = false;
+}
+
+static bool cbor_reserve(cbor_writer_t *w, size_t n)
+{
+    if (w->overflow || w->len + n > w->size) {
+        w->overflow = true;
+        return false;
+    }
+    return true;
+}
+
+// Cabecera con el argumento en la forma más corta posible
+static void cbor_put_head(cbor_writer_t *w, uint8_t major, uint32_t arg)
+{
+    uint8_t ib = major << 5;
+    if (arg < 24) {
+        if (!cbor_reserve(w, 1)) return;
+        w->buf[w->len++] = ib | arg;
+    } else if (arg <= 0xff) {
+        if (!cbor_reserve(w, 2)) return;
+        w->buf[w->len++] = ib | 24;
+        w->buf[w->len++] = arg;
+    } else if (arg <= 0xffff) {
+        if (!cbor_reserve(w, 3)) return;
+        w->buf[w->len++] = ib | 25;
+        w->buf[w->len++] = arg >> 8;
+        w->buf[w->len++] = arg;
+    } else {
+        if (!cbor_reserve(w, 5)) return;
+        w->buf[w->len++] = ib | 26;
+        w->buf[w->len++] = arg >> 24;
+        w->buf[w->len++] = arg >> 16;
+        w->buf[w->len++] = arg >> 8;
+        w->buf[w->len++] = arg;
+    }
+}
+
+void cbor_put_uint(cbor_writer_t *w, uint32_t value)
+{
+    cbor_put_head(w, CBOR_MAJOR_UINT, value);
+}
+
+void cbor_put_int(cbor_writer_t *w, int32_t value)
+{
+    if (value >= 0) {
+        cbor_put_head(w, CBOR_MAJOR_UINT, (uint32_t)value);
+    } else {
+        // Los negativos se codifican como -1 - n
+        cbor_put_head(w, CBOR_MAJOR_NEGINT, (uint32_t)(-1 - value));
+    }
+}
+
+void cbor_put_bool(cbor_writer_t *w, bool value)
+{
+    cbor_put_head(w, CBOR_MAJOR_SIMPLE, value ? CBOR_SIMPLE_TRUE : CBOR_SIMPLE_FALSE);
+}
+
+void cbor_put_null(cbor_writer_t *w)
+{
+    cbor_put_head(w, CBOR_MAJOR_SIMPLE, CBOR_SIMPLE_NULL);
+}
+
+void cbor_put_text(cbor_writer_t *w, const char *text, size_t len)
+{
+    cbor_put_head(w, CBOR_MAJOR_TEXT, len);
+    if (!cbor_reserve(w, len)) return;
+    memcpy(&w->buf[w->len], text, len);
+    w->len += len;
+}
+
+void cbor_put_map(cbor_writer_t *w, uint32_t pairs)
+{
+    cbor_put_head(w, CBOR_MAJOR_MAP, pairs);
+}
+
+void cbor_put_array(cbor_writer_t *w, uint32_t items)
+{
+    cbor_put_head(w, CBOR_MAJOR_ARRAY, items);
+}
+
+size_t cbor_writer_finish(const cbor_writer_t *w)
+{
+    return w->overflow ? 0 : w->len;
+}
\ No newline at end of file
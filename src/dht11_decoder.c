@@ -0,0 +1,48 @@
+#include "dht11_decoder.h"
+#include <string.h>
+
+dht11_decode_status_t dht11_decode_pulses(const uint16_t *pulses_us,size_t count,dht11_frame_t *frame)
+{
+    if(count < DHT11_FRAME_PULSES) return DHT11_DECODE_TRUNCATED;
+
+    memset(frame->raw, 0, sizeof(frame->raw));
+    for(int bit = 0; bit < DHT11_FRAME_BITS; bit++)
+    {
+        uint16_t low_us = pulses_us[2 * bit];
+        uint16_t high_us = pulses_us[2 * bit + 1];
+        if(low_us > DHT11_PULSE_MAX_US || high_us > DHT11_PULSE_MAX_US) return DHT11_DECODE_BAD_PULSE;
+
+        frame->raw[bit / 8] |= (high_us > low_us) << (7 - bit % 8);
+    }
+
+    frame->humidity_x10 = frame->raw[0] * 10 + frame->raw[1];
+    frame->temperature_x10 = frame->raw[2] * 10 + frame->raw[3];
+
+    uint8_t crc = frame->raw[0] + frame->raw[1] + frame->raw[2] + frame->raw[3];
+    if(crc != frame->raw[4]) return DHT11_DECODE_CHECKSUM;
+
+    return DHT11_DECODE_OK;
+}
+
+size_t dht11_edges_to_pulses(const uint32_t *edges_us,size_t edge_count,uint16_t *pulses_us)
+{
+    size_t count = 0;
+    for(size_t i = DHT11_FIRST_DATA_EDGE; i + 1 < edge_count && count < DHT11_FRAME_PULSES; i++)
+    {
+        uint32_t width = edges_us[i + 1] - edges_us[i];
+        pulses_us[count++] = width > UINT16_MAX ? UINT16_MAX : (uint16_t)width;
+    }
+    return count;
+}
+
+const char *dht11_decode_status_name(dht11_decode_status_t status)
+{
+    switch(status)
+    {
+        case DHT11_DECODE_OK: return "ok";
+        case DHT11_DECODE_TRUNCATED: return "truncated";
+        case DHT11_DECODE_BAD_PULSE: return "bad pulse";
+        case DHT11_DECODE_CHECKSUM: return "wrong checksum";
+    }
+    return "unknown";
+}
\ No newline at end of file
@@ -1,11 +1,35 @@
 #include "esp32-dht11.h"
+#include "dht11_decoder.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 
-int wait_for_state(dht11_t dht11,int state,int timeout)
+// Edges expected up to the falling edge that ends the last bit
+#define DHT11_DATA_EDGES (DHT11_FIRST_DATA_EDGE + DHT11_FRAME_PULSES + 1)
+// The whole transmission takes ~4.5 ms; wait a bit longer before giving up
+#define DHT11_CAPTURE_TIMEOUT_MS 10
+
+// vTaskDelay(n) can return up to one tick early (the first tick may be
+// about to fire), so a guaranteed minimum is ceil(ms / tick) + 1 ticks.
+#define DHT11_MIN_TICKS(ms) (((ms) + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1)
+
+typedef struct
+{
+    uint32_t edges_us[DHT11_MAX_EDGES];
+    volatile int edge_count;
+    SemaphoreHandle_t done;
+    int pin;
+} dht11_capture_t;
+
+static dht11_capture_t s_capture = { .pin = -1 };
+
+int wait_for_state(const dht11_t *dht11,int state,int timeout)
 {
-    gpio_set_direction(dht11.dht11_pin, GPIO_MODE_INPUT);
     int count = 0;
     
-    while(gpio_get_level(dht11.dht11_pin) != state)
+    while(gpio_get_level(dht11->dht11_pin) != state)
     {
         if(count >= timeout) return -1;
         count += 2;
@@ -16,37 +40,43 @@ int wait_for_state(dht11_t dht11,int state,int timeout)
     return  count;
 }
 
-void hold_low(dht11_t dht11,int hold_time_us)
+void hold_low(const dht11_t *dht11,int hold_time_us)
 {
-    gpio_set_direction(dht11.dht11_pin,GPIO_MODE_OUTPUT);
-    gpio_set_level(dht11.dht11_pin,0);
+    gpio_set_direction(dht11->dht11_pin,GPIO_MODE_OUTPUT);
+    gpio_set_level(dht11->dht11_pin,0);
     ets_delay_us(hold_time_us);
-    gpio_set_level(dht11.dht11_pin,1);
+    gpio_set_level(dht11->dht11_pin,1);
+}
+
+static int dht11_apply_frame(dht11_t *dht11,const uint16_t *pulses_us,size_t count)
+{
+    dht11_frame_t frame;
+    dht11_decode_status_t status = dht11_decode_pulses(pulses_us, count, &frame);
+    if(status != DHT11_DECODE_OK)
+    {
+        ESP_LOGE("DHT11:", "Decode failed: %s", dht11_decode_status_name(status));
+        return -1;
+    }
+    dht11->humidity = frame.humidity_x10 / 10.0;
+    dht11->temperature = frame.temperature_x10 / 10.0;
+    return 0;
 }
 
 int dht11_read(dht11_t *dht11,int connection_timeout)
 {
     int waited = 0;
-    int one_duration = 0;
-    int zero_duration = 0;
     int timeout_counter = 0;
-
-    uint8_t received_data[5] =
-    {
-        0x00,
-        0x00,
-        0x00,
-        0x00,
-        0x00
-    };
+    bool connected = false;
+    uint16_t pulses_us[DHT11_FRAME_PULSES];
 
     while(timeout_counter < connection_timeout)
     {
         timeout_counter++;
+        hold_low(dht11, 18000);
+        // The pin stays an input for the whole exchange
         gpio_set_direction(dht11->dht11_pin,GPIO_MODE_INPUT);
-        hold_low(*dht11, 18000);
         
-        waited = wait_for_state(*dht11,0,40);
+        waited = wait_for_state(dht11,0,40);
 
         if(waited == -1)
         {
@@ -56,7 +86,7 @@ int dht11_read(dht11_t *dht11,int connection_timeout)
         } 
 
 
-        waited = wait_for_state(*dht11,1,90);
+        waited = wait_for_state(dht11,1,90);
         if(waited == -1)
         {
             ESP_LOGE("DHT11:","Failed at phase 2");
@@ -64,37 +94,106 @@ int dht11_read(dht11_t *dht11,int connection_timeout)
             continue;
         } 
         
-        waited = wait_for_state(*dht11,0,90);
+        waited = wait_for_state(dht11,0,90);
         if(waited == -1)
         {
             ESP_LOGE("DHT11:","Failed at phase 3");
             ets_delay_us(20000);
             continue;
         } 
+        connected = true;
         break;
         
     }
     
-    if(timeout_counter == connection_timeout) return -1;
+    if(!connected) return -1;
 
-    for(int i = 0; i < 5; i++)
+    // Record pulse widths only; decoding happens once the frame is over.
+    // A timed-out wait counts as a pulse as long as its timeout.
+    for(int bit = 0; bit < DHT11_FRAME_BITS; bit++)
     {
-        for(int j = 0; j < 8; j++)
-        {
-            zero_duration = wait_for_state(*dht11,1,58);
-            one_duration = wait_for_state(*dht11,0,74);
-            received_data[i] |= (one_duration > zero_duration) << (7 - j);
-        }
+        int zero_duration = wait_for_state(dht11,1,58);
+        int one_duration = wait_for_state(dht11,0,74);
+        pulses_us[2 * bit] = zero_duration < 0 ? 58 : zero_duration;
+        pulses_us[2 * bit + 1] = one_duration < 0 ? 74 : one_duration;
     }
-    int crc = received_data[0]+received_data[1]+received_data[2]+received_data[3];
-    crc = crc & 0xff;
-    if(crc == received_data[4]) {
-      dht11->humidity = received_data[0] + received_data[1] / 10.0;
-      dht11->temperature = received_data[2] + received_data[3] / 10.0;
-      return 0;
+    return dht11_apply_frame(dht11, pulses_us, DHT11_FRAME_PULSES);
+}
+
+static void IRAM_ATTR dht11_edge_isr(void *arg)
+{
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    int n = s_capture.edge_count;
+    if(n >= DHT11_MAX_EDGES) return;
+
+    s_capture.edges_us[n] = now;
+    s_capture.edge_count = n + 1;
+
+    if(n + 1 == DHT11_DATA_EDGES)
+    {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(s_capture.done, &woken);
+        if(woken) portYIELD_FROM_ISR(woken);
+    }
+}
+
+static int dht11_capture_setup(int pin)
+{
+    if(s_capture.done == NULL)
+    {
+        s_capture.done = xSemaphoreCreateBinary();
+        if(s_capture.done == NULL) return -1;
     }
-    else {
-        ESP_LOGE("DHT11:", "Wrong checksum");
+    if(s_capture.pin == pin) return 0;
+
+    // Open drain with pull-up: driving 0 pulls the line low, driving 1 releases it
+    gpio_config_t conf = {
+        .pin_bit_mask = (1ULL << pin),
+        .mode = GPIO_MODE_INPUT_OUTPUT_OD,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE
+    };
+    gpio_config(&conf);
+    gpio_set_level(pin, 1);
+
+    esp_err_t err = gpio_install_isr_service(0);
+    if(err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE("DHT11:", "ISR service install failed: %s", esp_err_to_name(err));
         return -1;
     }
+    gpio_isr_handler_add(pin, dht11_edge_isr, NULL);
+    s_capture.pin = pin;
+    return 0;
 }
+
+int dht11_read_isr(dht11_t *dht11,int connection_timeout)
+{
+    if(dht11_capture_setup(dht11->dht11_pin) != 0) return -1;
+
+    uint16_t pulses_us[DHT11_FRAME_PULSES];
+    for(int attempt = 0; attempt < connection_timeout; attempt++)
+    {
+        if(attempt > 0) vTaskDelay(DHT11_MIN_TICKS(20));
+
+        // Start signal: at least 18 ms low (20-30 ms at 100 Hz)
+        gpio_set_intr_type(dht11->dht11_pin, GPIO_INTR_DISABLE);
+        gpio_set_level(dht11->dht11_pin, 0);
+        vTaskDelay(DHT11_MIN_TICKS(18));
+
+        s_capture.edge_count = 0;
+        xSemaphoreTake(s_capture.done, 0);
+        gpio_set_intr_type(dht11->dht11_pin, GPIO_INTR_ANYEDGE);
+        gpio_intr_enable(dht11->dht11_pin);
+        gpio_set_level(dht11->dht11_pin, 1);
+
+        // The task sleeps while the ISR timestamps the transmission
+        xSemaphoreTake(s_capture.done, DHT11_MIN_TICKS(DHT11_CAPTURE_TIMEOUT_MS));
+        gpio_set_intr_type(dht11->dht11_pin, GPIO_INTR_DISABLE);
+
+        size_t count = dht11_edges_to_pulses(s_capture.edges_us, s_capture.edge_count, pulses_us);
+        if(dht11_apply_frame(dht11, pulses_us, count) == 0) return 0;
+    }
+    return -1;
+}
\ No newline at end of file
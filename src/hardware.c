@@ -3,46 +3,275 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_pm.h"
+#include "freertos/queue.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#include <stdatomic.h>
 // Biblioteca DHT (esp32-dht11)
 #include "esp32-dht11.h"
+#include "sensor_history.h"
+#include <math.h>
 
 static const char *TAG = "HARDWARE";
 
 // Variables de estado
 static led_state_t current_led_state = LED_OFF;
-static button_state_t last_button_state = BUTTON_RELEASED;
-static uint32_t press_count = 0;
-static uint32_t last_debounce_time = 0;
-static const uint32_t DEBOUNCE_DELAY = 50; // ms
+static volatile button_state_t s_button_state = BUTTON_RELEASED;
+static volatile uint32_t press_count = 0;
 
-// DHT11 - lecturas en segundo plano
-static float s_last_temperature = 0.0f;
-static float s_last_humidity = 0.0f;
-static bool s_sensor_valid = false;
+// Cola de flancos ISR -> button_task. Un solo productor (la ISR) y un solo
+// consumidor (la tarea): bastan dos índices atómicos, sin secciones críticas.
+typedef struct {
+    int64_t time_us;
+    uint8_t level;
+} button_edge_t;
 
-// Tarea que lee el DHT11 periódicamente
+#define BUTTON_EDGE_MASK (BUTTON_EDGE_QUEUE_LEN - 1)
+_Static_assert((BUTTON_EDGE_QUEUE_LEN & BUTTON_EDGE_MASK) == 0, "BUTTON_EDGE_QUEUE_LEN debe ser potencia de 2");
+
+static button_edge_t s_edges[BUTTON_EDGE_QUEUE_LEN];
+static atomic_uint s_edge_head = 0;     // Lo avanza la ISR
+static atomic_uint s_edge_tail = 0;     // Lo avanza button_task
+static atomic_uint s_edge_dropped = 0;
+static TaskHandle_t s_button_task = NULL;
+static QueueHandle_t s_button_events = NULL;
+static void (*s_button_listener)(void) = NULL;
+static TaskHandle_t s_dht_task = NULL;
+static esp_pm_lock_handle_t s_dht_pm_lock = NULL;
+static esp_pm_lock_handle_t s_dht_cpu_lock = NULL;
+
+// Versiones de estado: se incrementan en cada cambio para que los
+// consumidores (pantalla, web) detecten cambios sin comparar valores
+static volatile uint32_t s_led_version = 0;
+static volatile uint32_t s_button_version = 0;
+
+// Estado, versión y nivel del pin cambian juntos: el LED se controla desde
+// httpd, MQTT, button_task y el temporizador de secuencias de /led
+static portMUX_TYPE s_led_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// DHT11 - última lectura publicada con un seqlock. dht_task es el único
+// escritor; los lectores copian la instantánea y reintentan si el contador
+// cambió durante la copia (o era impar: escritura en curso).
+static sensor_snapshot_t s_sensor_snapshot;
+static atomic_uint s_sensor_seqlock = 0;
+static portMUX_TYPE s_sensor_write_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void sensor_snapshot_publish(const sensor_snapshot_t *snapshot) {
+    // La sección crítica evita que un lector de mayor prioridad expulse al
+    // escritor a mitad de la copia y quede girando en el mismo núcleo
+    portENTER_CRITICAL(&s_sensor_write_mux);
+    unsigned seq = atomic_load_explicit(&s_sensor_seqlock, memory_order_relaxed);
+    atomic_store_explicit(&s_sensor_seqlock, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s_sensor_snapshot = *snapshot;
+    atomic_store_explicit(&s_sensor_seqlock, seq + 2, memory_order_release);
+    portEXIT_CRITICAL(&s_sensor_write_mux);
+}
+
+// Tarea que lee el DHT11: una lectura al arrancar y otra cada vez que se
+// pide con hardware_request_sensor_read() (el planificador marca el ritmo)
 static void dht_task(void *arg) {
     dht11_t dht;
     dht.dht11_pin = DHT11_GPIO;
     dht.temperature = 0.0f;
     dht.humidity = 0.0f;
 
-    const TickType_t delay = pdMS_TO_TICKS(5000); // 5 segundos entre lecturas
+    // Solo esta tarea modifica la instantánea; se trabaja sobre una copia local
+    sensor_snapshot_t snapshot = {0};
 
     while (1) {
-        int res = dht11_read(&dht, 3);
+        // Captura por interrupción: la tarea duerme durante la lectura, pero
+        // el chip no puede entrar en light sleep o se perderían flancos, ni
+        // bajar a la frecuencia mínima: la latencia de la ISR a 40 MHz
+        // desplaza las marcas de tiempo que distinguen pulsos de 26 y 70 µs
+        if (s_dht_pm_lock) esp_pm_lock_acquire(s_dht_pm_lock);
+        if (s_dht_cpu_lock) esp_pm_lock_acquire(s_dht_cpu_lock);
+        int res = dht11_read_isr(&dht, 3);
+        if (s_dht_cpu_lock) esp_pm_lock_release(s_dht_cpu_lock);
+        if (s_dht_pm_lock) esp_pm_lock_release(s_dht_pm_lock);
         if (res == 0) {
-            s_last_temperature = dht.temperature;
-            s_last_humidity = dht.humidity;
-            s_sensor_valid = true;
-            ESP_LOGI(TAG, "DHT11 lectura OK - Temp: %.1f C, Hum: %.1f%%", s_last_temperature, s_last_humidity);
+            snapshot.temperature = dht.temperature;
+            snapshot.humidity = dht.humidity;
+            snapshot.temperature_x10 = (int16_t)lroundf(dht.temperature * 10);
+            snapshot.humidity_x10 = (uint16_t)lroundf(dht.humidity * 10);
+            snapshot.valid = true;
+            snapshot.timestamp_us = esp_timer_get_time();
+            snapshot.sample_seq++;
+            snapshot.fail_count = 0;
+            sensor_history_add((uint32_t)(snapshot.timestamp_us / 1000000),
+                               snapshot.temperature_x10, snapshot.humidity_x10);
+            ESP_LOGI(TAG, "DHT11 lectura OK - Temp: %.1f C, Hum: %.1f%%", snapshot.temperature, snapshot.humidity);
         } else {
-            s_sensor_valid = false;
-            ESP_LOGW(TAG, "DHT11 lectura fallida");
+            snapshot.valid = false;
+            snapshot.fail_count++;
+            ESP_LOGW(TAG, "DHT11 lectura fallida (%lu seguidas)", snapshot.fail_count);
+        }
+        sensor_snapshot_publish(&snapshot);
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+// El GPIO lee 0 (LOW) con el botón PRESIONADO y 1 (HIGH) LIBERADO.
+// La interrupción es por nivel y se reprograma al nivel contrario del que se
+// acaba de leer: equivale a ambos flancos y, a diferencia de ellos, también
+// despierta al chip del light sleep.
+static void IRAM_ATTR button_edge_isr(void *arg) {
+    uint32_t level = gpio_ll_get_level(&GPIO, BUTTON_GPIO);
+    gpio_ll_set_intr_type(&GPIO, BUTTON_GPIO, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    
+    unsigned head = atomic_load_explicit(&s_edge_head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&s_edge_tail, memory_order_acquire);
+    if (head - tail >= BUTTON_EDGE_QUEUE_LEN) {
+        atomic_fetch_add_explicit(&s_edge_dropped, 1, memory_order_relaxed);
+    } else {
+        s_edges[head & BUTTON_EDGE_MASK] = (button_edge_t) {
+            .time_us = esp_timer_get_time(),
+            .level = level,
+        };
+        atomic_store_explicit(&s_edge_head, head + 1, memory_order_release);
+    }
+    
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_button_task, &woken);
+    if (woken) portYIELD_FROM_ISR(woken);
+}
+
+static bool button_pop_edge(button_edge_t *edge) {
+    unsigned tail = atomic_load_explicit(&s_edge_tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&s_edge_head, memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    *edge = s_edges[tail & BUTTON_EDGE_MASK];
+    atomic_store_explicit(&s_edge_tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static void button_emit(button_event_type_t type, int64_t time_us, uint32_t duration_ms) {
+    button_event_t event = { .type = type, .time_us = time_us, .duration_ms = duration_ms };
+    // Si nadie consume eventos la cola se llena y se descartan: el contador
+    // y el LED ya se actualizaron
+    xQueueSend(s_button_events, &event, 0);
+    if (s_button_listener != NULL) {
+        s_button_listener();
+    }
+}
+
+// Estado de detección de gestos; solo lo usa button_task
+static int64_t s_pressed_at = 0;
+static int64_t s_last_press_at = INT64_MIN / 2;
+static bool s_long_sent = false;
+
+// Cambio de estado ya filtrado. La pulsación actúa en el acto: el contador
+// y el LED no esperan a saber si habrá doble pulsación o pulsación larga.
+static void button_apply(bool pressed, int64_t time_us) {
+    s_button_state = pressed ? BUTTON_PRESSED : BUTTON_RELEASED;
+    s_button_version++;
+    
+    if (pressed) {
+        press_count++;
+        led_toggle(); // Cambiar estado del LED
+        ESP_LOGI(TAG, "Botón presionado - LED: %s", led_get_state() ? "ON" : "OFF");
+        button_emit(BUTTON_EVENT_PRESS, time_us, 0);
+        if (time_us - s_last_press_at <= (int64_t)BUTTON_DOUBLE_PRESS_MS * 1000) {
+            button_emit(BUTTON_EVENT_DOUBLE_PRESS, time_us, 0);
+            s_last_press_at = INT64_MIN / 2;    // Una tercera pulsación no es otra doble
+        } else {
+            s_last_press_at = time_us;
+        }
+        s_pressed_at = time_us;
+        s_long_sent = false;
+    } else {
+        button_emit(BUTTON_EVENT_RELEASE, time_us, (uint32_t)((time_us - s_pressed_at) / 1000));
+    }
+}
+
+// Antirrebote por marcas de tiempo: el primer flanco de cada cambio se
+// acepta al instante y los siguientes BUTTON_DEBOUNCE_US se ignoran. Cuando
+// el pin lleva BUTTON_DEBOUNCE_US sin flancos se lee su nivel; si no
+// coincide (p. ej. una pulsación más corta que la ventana, o un rebote leído
+// a destiempo en la ISR) se aplica ese cambio, así no se pierde ninguno
+// aunque se desborde la cola.
+static void button_task(void *arg) {
+    int64_t lockout_until = 0;
+    int64_t settle_at = 0;
+    bool reconcile = false;
+    s_button_state = gpio_get_level(BUTTON_GPIO) == 0 ? BUTTON_PRESSED : BUTTON_RELEASED;
+    
+    while (1) {
+        int64_t now = esp_timer_get_time();
+        int64_t deadline = INT64_MAX;
+        if (reconcile) {
+            deadline = settle_at;
+        }
+        if (s_button_state == BUTTON_PRESSED && !s_long_sent) {
+            int64_t long_at = s_pressed_at + (int64_t)BUTTON_LONG_PRESS_MS * 1000;
+            if (long_at < deadline) deadline = long_at;
+        }
+        TickType_t wait = portMAX_DELAY;
+        if (deadline != INT64_MAX) {
+            // Redondeo hacia arriba: despertar antes de tiempo no sirve
+            wait = deadline > now ? pdMS_TO_TICKS((deadline - now + 999) / 1000) + 1 : 0;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+        
+        button_edge_t edge;
+        while (button_pop_edge(&edge)) {
+            if (edge.time_us + BUTTON_DEBOUNCE_US > settle_at) {
+                settle_at = edge.time_us + BUTTON_DEBOUNCE_US;
+            }
+            reconcile = true;
+            bool pressed = edge.level == 0;
+            if (edge.time_us < lockout_until || pressed == (s_button_state == BUTTON_PRESSED)) {
+                continue;   // Rebote o flanco sin cambio de estado
+            }
+            button_apply(pressed, edge.time_us);
+            lockout_until = edge.time_us + BUTTON_DEBOUNCE_US;
+        }
+        
+        now = esp_timer_get_time();
+        if (reconcile && now >= settle_at) {
+            reconcile = false;
+            bool pressed = gpio_get_level(BUTTON_GPIO) == 0;
+            if (pressed != (s_button_state == BUTTON_PRESSED)) {
+                button_apply(pressed, now);
+                lockout_until = now + BUTTON_DEBOUNCE_US;
+            }
+        }
+        
+        if (s_button_state == BUTTON_PRESSED && !s_long_sent &&
+            now - s_pressed_at >= (int64_t)BUTTON_LONG_PRESS_MS * 1000) {
+            s_long_sent = true;
+            ESP_LOGI(TAG, "Pulsación larga");
+            button_emit(BUTTON_EVENT_LONG_PRESS, now, (uint32_t)((now - s_pressed_at) / 1000));
         }
+    }
+}
 
-        vTaskDelay(delay);
+static void button_init(void) {
+    s_button_events = xQueueCreate(8, sizeof(button_event_t));
+    BaseType_t t = xTaskCreate(button_task, "button_task", 3072, NULL, BUTTON_TASK_PRIORITY, &s_button_task);
+    if (s_button_events == NULL || t != pdPASS) {
+        ESP_LOGE(TAG, "No se pudo crear button_task");
+        return;
+    }
+    
+    // El servicio puede estar ya instalado (lo usa también el DHT11)
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "gpio_install_isr_service: %s", esp_err_to_name(err));
+        return;
     }
+    gpio_int_type_t type = gpio_get_level(BUTTON_GPIO) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL;
+    gpio_isr_handler_add(BUTTON_GPIO, button_edge_isr, NULL);
+    gpio_set_intr_type(BUTTON_GPIO, type);
+    // Fuente de despertar del light sleep (power.c); usa el mismo nivel
+    gpio_wakeup_enable(BUTTON_GPIO, type);
+    gpio_intr_enable(BUTTON_GPIO);
 }
 
 void hardware_init(void) {
@@ -69,34 +298,62 @@ void hardware_init(void) {
     // Estado inicial del LED
     led_set(LED_OFF);
     
+    button_init();
+    
     ESP_LOGI(TAG, "Hardware inicializado - LED: GPIO%d, Botón: GPIO%d", LED_GPIO, BUTTON_GPIO);
 
+    // Histórico en RAM alimentado por dht_task
+    sensor_history_init();
+    
+    // Sin CONFIG_PM_ENABLE no hay cerrojos y la lectura no los necesita
+    if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "dht11", &s_dht_pm_lock) != ESP_OK) {
+        s_dht_pm_lock = NULL;
+    }
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "dht11_cpu", &s_dht_cpu_lock) != ESP_OK) {
+        s_dht_cpu_lock = NULL;
+    }
+    
     // Crear tarea de lectura del DHT11
-    BaseType_t t = xTaskCreatePinnedToCore(dht_task, "dht_task", 2048, NULL, 5, NULL, 0);
+    BaseType_t t = xTaskCreatePinnedToCore(dht_task, "dht_task", 2048, NULL, 5, &s_dht_task, 0);
     if (t != pdPASS) {
         ESP_LOGW(TAG, "No se pudo crear tarea dht_task");
     }
 }
 
 void led_set(led_state_t state) {
+    portENTER_CRITICAL(&s_led_mux);
+    if (state != current_led_state) s_led_version++;
     current_led_state = state;
     gpio_set_level(LED_GPIO, state);
+    portEXIT_CRITICAL(&s_led_mux);
 }
 
 void led_toggle(void) {
+    portENTER_CRITICAL(&s_led_mux);
     current_led_state = !current_led_state;
+    s_led_version++;
     gpio_set_level(LED_GPIO, current_led_state);
+    portEXIT_CRITICAL(&s_led_mux);
 }
 
 led_state_t led_get_state(void) {
     return current_led_state;
 }
 
+uint32_t led_get_version(void) {
+    return s_led_version;
+}
+
+void led_apply_action(int action) {
+    switch (action) {
+        case 0: led_set(LED_OFF); break;
+        case 1: led_set(LED_ON);  break;
+        default: led_toggle();    break;
+    }
+}
+
 button_state_t button_read(void) {
-int level = gpio_get_level(BUTTON_GPIO);
-    // Si el GPIO lee 0 (LOW), el botón está PRESIONADO
-    // Si el GPIO lee 1 (HIGH), el botón está LIBERADO
-    return (level == 0) ? BUTTON_PRESSED : BUTTON_RELEASED;
+    return s_button_state;
 }
 
 bool button_is_pressed(void) {
@@ -107,34 +364,57 @@ uint32_t button_get_press_count(void) {
     return press_count;
 }
 
-void hardware_update(void) {
-    // Leer estado actual del botón
-    button_state_t current_button_state = button_read();
-    
-    // Detectar flanco de bajada (botón presionado)
-    if (current_button_state == BUTTON_PRESSED && last_button_state == BUTTON_RELEASED) {
-        uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        
-        // Debounce
-        if ((current_time - last_debounce_time) > DEBOUNCE_DELAY) {
-            press_count++;
-            led_toggle(); // Cambiar estado del LED
-            ESP_LOGI(TAG, "Botón presionado - LED: %s", led_get_state() ? "ON" : "OFF");
-            last_debounce_time = current_time;
-        }
+uint32_t button_get_version(void) {
+    return s_button_version;
+}
+
+bool button_get_event(button_event_t *event) {
+    return s_button_events != NULL && xQueueReceive(s_button_events, event, 0) == pdTRUE;
+}
+
+void button_set_listener(void (*listener)(void)) {
+    s_button_listener = listener;
+}
+
+uint32_t button_get_dropped_edges(void) {
+    return atomic_load_explicit(&s_edge_dropped, memory_order_relaxed);
+}
+
+void hardware_request_sensor_read(void) {
+    if (s_dht_task != NULL) {
+        xTaskNotifyGive(s_dht_task);
     }
-    
-    last_button_state = current_button_state;
+}
+
+void hardware_get_sensor_snapshot(sensor_snapshot_t *out) {
+    unsigned before, after;
+    do {
+        before = atomic_load_explicit(&s_sensor_seqlock, memory_order_acquire);
+        *out = s_sensor_snapshot;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&s_sensor_seqlock, memory_order_relaxed);
+    } while ((before & 1) || before != after);
 }
 
 float hardware_get_temperature(void) {
-    return s_last_temperature;
+    sensor_snapshot_t snapshot;
+    hardware_get_sensor_snapshot(&snapshot);
+    return snapshot.temperature;
 }
 
 float hardware_get_humidity(void) {
-    return s_last_humidity;
+    sensor_snapshot_t snapshot;
+    hardware_get_sensor_snapshot(&snapshot);
+    return snapshot.humidity;
 }
 
 bool hardware_sensor_valid(void) {
-    return s_sensor_valid;
+    sensor_snapshot_t snapshot;
+    hardware_get_sensor_snapshot(&snapshot);
+    return snapshot.valid;
+}
+
+uint32_t hardware_get_sensor_version(void) {
+    // Cambia con cada escritura de la instantánea (lectura OK o fallida)
+    return atomic_load_explicit(&s_sensor_seqlock, memory_order_acquire) / 2;
 }
\ No newline at end of file
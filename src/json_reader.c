@@ -0,0 +1,437 @@
+#include "json_reader.h"
+#include <string.h>
+
+// Qué admite el lector fuera de un token
+typedef enum {
+    EXPECT_VALUE,           // Al empezar, tras ':' o tras ',' en un array
+    EXPECT_VALUE_OR_END,    // Tras '['
+    EXPECT_KEY_OR_END,      // Tras '{'
+    EXPECT_KEY,             // Tras ',' en un objeto
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_END,    // Tras un valor dentro de un contenedor
+    EXPECT_DONE,            // Ya se leyó el valor raíz
+} json_expect_t;
+
+// Token a medio leer
+typedef enum {
+    LEX_NONE,
+    LEX_STRING,
+    LEX_KEY,
+    LEX_NUMBER,
+    LEX_LITERAL,
+} json_lex_t;
+
+void json_reader_init(json_reader_t *r, json_token_fn_t fn, void *ctx)
+{
+    memset(r, 0, sizeof(*r));
+    r->fn = fn;
+    r->ctx = ctx;
+    r->error = JSON_READER_OK;
+    r->expect = EXPECT_VALUE;
+    r->lex = LEX_NONE;
+}
+
+static bool json_fail(json_reader_t *r, json_reader_error_t error)
+{
+    r->error = error;
+    return false;
+}
+
+static bool json_emit(json_reader_t *r, json_token_type_t type)
+{
+    r->buf[r->len] = '\0';
+    json_token_t tok = {
+        .type = type,
+        .depth = r->depth,
+        .text = r->buf,
+        .len = r->len,
+    };
+    if (!r->fn(r->ctx, &tok)) {
+        return json_fail(r, JSON_READER_ABORTED);
+    }
+    return true;
+}
+
+// Tras un valor completo: fin del documento o separador del contenedor
+static void json_value_done(json_reader_t *r)
+{
+    r->expect = r->depth == 0 ? EXPECT_DONE : EXPECT_COMMA_OR_END;
+}
+
+static bool json_put(json_reader_t *r, char c)
+{
+    if (r->len >= JSON_READER_MAX_TOKEN) {
+        return json_fail(r, JSON_READER_TOO_LONG);
+    }
+    r->buf[r->len++] = c;
+    return true;
+}
+
+static bool json_is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool json_number_valid(const char *s)
+{
+    if (*s == '-') s++;
+    if (*s == '0') {
+        s++;
+    } else if (json_is_digit(*s)) {
+        while (json_is_digit(*s)) s++;
+    } else {
+        return false;
+    }
+    if (*s == '.') {
+        s++;
+        if (!json_is_digit(*s)) return false;
+        while (json_is_digit(*s)) s++;
+    }
+    if (*s == 'e' || *s == 'E') {
+        s++;
+        if (*s == '+' || *s == '-') s++;
+        if (!json_is_digit(*s)) return false;
+        while (json_is_digit(*s)) s++;
+    }
+    return *s == '\0';
+}
+
+// Un número no tiene delimitador: termina con el primer carácter ajeno
+static bool json_number_end(json_reader_t *r)
+{
+    r->lex = LEX_NONE;
+    r->buf[r->len] = '\0';
+    if (!json_number_valid(r->buf)) {
+        return json_fail(r, JSON_READER_SYNTAX);
+    }
+    if (!json_emit(r, JSON_TOK_NUMBER)) {
+        return false;
+    }
+    json_value_done(r);
+    return true;
+}
+
+static bool json_put_utf8(json_reader_t *r, uint16_t code)
+{
+    if (code < 0x80) {
+        return json_put(r, (char)code);
+    }
+    if (code < 0x800) {
+        return json_put(r, (char)(0xC0 | (code >> 6))) &&
+               json_put(r, (char)(0x80 | (code & 0x3F)));
+    }
+    return json_put(r, (char)(0xE0 | (code >> 12))) &&
+           json_put(r, (char)(0x80 | ((code >> 6) & 0x3F))) &&
+           json_put(r, (char)(0x80 | (code & 0x3F)));
+}
+
+static int json_hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// escape: 0 = normal, 1 = tras '\', 2..5 = dígitos de \uXXXX
+static bool json_string_char(json_reader_t *r, char c)
+{
+    if (r->escape == 1) {
+        r->escape = 0;
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/': return json_put(r, c);
+            case 'b': return json_put(r, '\b');
+            case 'f': return json_put(r, '\f');
+            case 'n': return json_put(r, '\n');
+            case 'r': return json_put(r, '\r');
+            case 't': return json_put(r, '\t');
+            case 'u':
+                r->escape = 2;
+                r->code = 0;
+                return true;
+            default:
+                return json_fail(r, JSON_READER_SYNTAX);
+        }
+    }
+    if (r->escape >= 2) {
+        int value = json_hex_value(c);
+        if (value < 0) {
+            return json_fail(r, JSON_READER_SYNTAX);
+        }
+        r->code = (uint16_t)((r->code << 4) | value);
+        if (++r->escape == 6) {
+            r->escape = 0;
+            return json_put_utf8(r, r->code);
+        }
+        return true;
+    }
+
+    if (c == '\\') {
+        r->escape = 1;
+        return true;
+    }
+    if (c == '"') {
+        bool key = (r->lex == LEX_KEY);
+        r->lex = LEX_NONE;
+        if (!json_emit(r, key ? JSON_TOK_KEY : JSON_TOK_STRING)) {
+            return false;
+        }
+        if (key) {
+            r->expect = EXPECT_COLON;
+        } else {
+            json_value_done(r);
+        }
+        return true;
+    }
+    if ((unsigned char)c < 0x20) {
+        return json_fail(r, JSON_READER_SYNTAX);
+    }
+    return json_put(r, c);
+}
+
+// true, false y null se comparan letra a letra; len es la posición
+static bool json_literal_char(json_reader_t *r, char c)
+{
+    if (c != r->literal[r->len]) {
+        return json_fail(r, JSON_READER_SYNTAX);
+    }
+    if (r->literal[++r->len] != '\0') {
+        return true;
+    }
+
+    json_token_type_t type = r->literal[0] == 't' ? JSON_TOK_TRUE
+                           : r->literal[0] == 'f' ? JSON_TOK_FALSE
+                           : JSON_TOK_NULL;
+    r->lex = LEX_NONE;
+    r->len = 0;
+    if (!json_emit(r, type)) {
+        return false;
+    }
+    json_value_done(r);
+    return true;
+}
+
+static bool json_open(json_reader_t *r, bool object)
+{
+    if (r->depth >= JSON_READER_MAX_DEPTH) {
+        return json_fail(r, JSON_READER_TOO_DEEP);
+    }
+    if (!json_emit(r, object ? JSON_TOK_OBJ_BEGIN : JSON_TOK_ARR_BEGIN)) {
+        return false;
+    }
+    uint16_t bit = 1u << r->depth;
+    if (object) {
+        r->is_object |= bit;
+    } else {
+        r->is_object &= ~bit;
+    }
+    r->depth++;
+    r->expect = object ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+    return true;
+}
+
+static bool json_in_object(const json_reader_t *r)
+{
+    return r->depth > 0 && (r->is_object & (1u << (r->depth - 1)));
+}
+
+static bool json_close(json_reader_t *r, bool object)
+{
+    if (r->depth == 0 || json_in_object(r) != object) {
+        return json_fail(r, JSON_READER_SYNTAX);
+    }
+    r->depth--;
+    r->len = 0;
+    if (!json_emit(r, object ? JSON_TOK_OBJ_END : JSON_TOK_ARR_END)) {
+        return false;
+    }
+    json_value_done(r);
+    return true;
+}
+
+static bool json_value_start(json_reader_t *r, char c)
+{
+    r->len = 0;
+    switch (c) {
+        case '{': return json_open(r, true);
+        case '[': return json_open(r, false);
+        case '"':
+            r->lex = LEX_STRING;
+            r->escape = 0;
+            return true;
+        case 't': r->literal = "true"; break;
+        case 'f': r->literal = "false"; break;
+        case 'n': r->literal = "null"; break;
+        default:
+            if (c == '-' || json_is_digit(c)) {
+                r->lex = LEX_NUMBER;
+                return json_put(r, c);
+            }
+            return json_fail(r, JSON_READER_SYNTAX);
+    }
+    r->lex = LEX_LITERAL;
+    r->len = 1;
+    return true;
+}
+
+static bool json_char(json_reader_t *r, char c)
+{
+    switch (r->lex) {
+        case LEX_STRING:
+        case LEX_KEY:
+            return json_string_char(r, c);
+        case LEX_LITERAL:
+            return json_literal_char(r, c);
+        case LEX_NUMBER:
+            if (json_is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+                return json_put(r, c);
+            }
+            if (!json_number_end(r)) {
+                return false;
+            }
+            break;      // c se procesa abajo
+        default:
+            break;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        return true;
+    }
+
+    switch (r->expect) {
+        case EXPECT_VALUE:
+            return json_value_start(r, c);
+        case EXPECT_VALUE_OR_END:
+            return c == ']' ? json_close(r, false) : json_value_start(r, c);
+        case EXPECT_KEY_OR_END:
+            if (c == '}') {
+                return json_close(r, true);
+            }
+            // fall through
+        case EXPECT_KEY:
+            if (c != '"') {
+                return json_fail(r, JSON_READER_SYNTAX);
+            }
+            r->lex = LEX_KEY;
+            r->len = 0;
+            r->escape = 0;
+            return true;
+        case EXPECT_COLON:
+            if (c != ':') {
+                return json_fail(r, JSON_READER_SYNTAX);
+            }
+            r->expect = EXPECT_VALUE;
+            return true;
+        case EXPECT_COMMA_OR_END:
+            if (c == ',') {
+                r->expect = json_in_object(r) ? EXPECT_KEY : EXPECT_VALUE;
+                return true;
+            }
+            if (c == '}' || c == ']') {
+                return json_close(r, c == '}');
+            }
+            return json_fail(r, JSON_READER_SYNTAX);
+        default:
+            return json_fail(r, JSON_READER_SYNTAX);
+    }
+}
+
+bool json_reader_feed(json_reader_t *r, const char *data, size_t len)
+{
+    if (r->error != JSON_READER_OK) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!json_char(r, data[i])) {
+            return false;
+        }
+        r->offset++;
+    }
+    return true;
+}
+
+bool json_reader_finish(json_reader_t *r)
+{
+    if (r->error != JSON_READER_OK) {
+        return false;
+    }
+    if (r->lex == LEX_NUMBER && !json_number_end(r)) {
+        return false;
+    }
+    if (r->lex != LEX_NONE || r->expect != EXPECT_DONE) {
+        return json_fail(r, JSON_READER_INCOMPLETE);
+    }
+    return true;
+}
+
+const char *json_reader_error_str(json_reader_error_t error)
+{
+    switch (error) {
+        case JSON_READER_OK:         return "OK";
+        case JSON_READER_SYNTAX:     return "JSON no válido";
+        case JSON_READER_TOO_DEEP:   return "Demasiado anidamiento";
+        case JSON_READER_TOO_LONG:   return "Cadena o número demasiado largo";
+        case JSON_READER_INCOMPLETE: return "JSON incompleto";
+        case JSON_READER_ABORTED:    return "Contenido no válido";
+        default:                     return "Error";
+    }
+}
+
+bool json_token_to_int(const json_token_t *tok, int32_t *out)
+{
+    if (tok->type != JSON_TOK_NUMBER) {
+        return false;
+    }
+    const char *s = tok->text;
+    bool negative = (*s == '-');
+    if (negative) s++;
+
+    int64_t value = 0;
+    for (; *s != '\0'; s++) {
+        if (!json_is_digit(*s)) {
+            return false;       // Decimales o exponente
+        }
+        value = value * 10 + (*s - '0');
+        if (value > (int64_t)INT32_MAX + 1) {
+            return false;
+        }
+    }
+    if (negative) value = -value;
+    if (value > INT32_MAX) {
+        return false;
+    }
+    *out = (int32_t)value;
+    return true;
+}
+static const char *const LED_ACTION_NAMES[] = { "off", "on", "toggle" };
+#define LED_ACTION_COUNT (int)(sizeof(LED_ACTION_NAMES) / sizeof(LED_ACTION_NAMES[0]))
+
+static int led_action_from_name(const char *name)
+{
+    for (int i = 0; i < LED_ACTION_COUNT; i++) {
+        if (strcmp(name, LED_ACTION_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int led_action_from_token(const json_token_t *tok)
+{
+    int32_t number;
+    if (tok->type == JSON_TOK_NUMBER) {
+        return json_token_to_int(tok, &number) && number >= 0 && number < LED_ACTION_COUNT ? number : -1;
+    }
+    return tok->type == JSON_TOK_STRING ? led_action_from_name(tok->text) : -1;
+}
+
+int led_action_from_text(const char *text)
+{
+    if (text[0] >= '0' && text[0] < '0' + LED_ACTION_COUNT && text[1] == '\0') {
+        return text[0] - '0';
+    }
+    return led_action_from_name(text);
+}
@@ -0,0 +1,310 @@
+#include "json_writer.h"
+#include <string.h>
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->overflow = (size == 0);
+    w->depth = 0;
+    w->has_items = 0;
+    w->after_key = false;
+}
+
+// Siempre se deja sitio para el '\0' final
+static void json_raw(json_writer_t *w, const char *data, size_t len)
+{
+    if (w->overflow || w->len + len + 1 > w->size) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->len], data, len);
+    w->len += len;
+}
+
+static void json_char(json_writer_t *w, char c)
+{
+    json_raw(w, &c, 1);
+}
+
+// Coma antes de cada elemento salvo el primero del nivel
+static void json_before_value(json_writer_t *w)
+{
+    if (w->after_key) {
+        w->after_key = false;
+        return;
+    }
+    if (w->depth == 0) {
+        return;
+    }
+    uint16_t bit = 1u << (w->depth - 1);
+    if (w->has_items & bit) {
+        json_char(w, ',');
+    }
+    w->has_items |= bit;
+}
+
+static void json_open(json_writer_t *w, char c)
+{
+    json_before_value(w);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->overflow = true;
+        return;
+    }
+    json_char(w, c);
+    w->depth++;
+    w->has_items &= ~(1u << (w->depth - 1));
+}
+
+static void json_close(json_writer_t *w, char c)
+{
+    if (w->depth == 0) {
+        w->overflow = true;
+        return;
+    }
+    w->depth--;
+    json_char(w, c);
+}
+
+void json_obj_begin(json_writer_t *w) { json_open(w, '{'); }
+void json_obj_end(json_writer_t *w)   { json_close(w, '}'); }
+void json_arr_begin(json_writer_t *w) { json_open(w, '['); }
+void json_arr_end(json_writer_t *w)   { json_close(w, ']'); }
+
+// Escapa comillas, barra invertida y caracteres de control; el resto de
+// UTF-8 pasa tal cual
+static void json_string(json_writer_t *w, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+    json_char(w, '"');
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        json_raw(w, run, s - run);
+        char esc[6] = { '\\', 0 };
+        size_t n = 2;
+        switch (c) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            default:
+                esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+                esc[4] = hex[c >> 4]; esc[5] = hex[c & 0xf];
+                n = 6;
+                break;
+        }
+        json_raw(w, esc, n);
+        run = s + 1;
+    }
+    json_raw(w, run, s - run);
+    json_char(w, '"');
+}
+
+void json_key(json_writer_t *w, const char *key)
+{
+    json_before_value(w);
+    json_string(w, key);
+    json_char(w, ':');
+    w->after_key = true;
+}
+
+// Dígitos de derecha a izquierda; min_digits rellena con ceros
+static void json_digits(json_writer_t *w, bool negative, uint64_t value, uint8_t min_digits)
+{
+    char tmp[21];
+    size_t pos = sizeof(tmp);
+    do {
+        tmp[--pos] = '0' + (value % 10);
+        value /= 10;
+    } while ((value != 0 || sizeof(tmp) - pos < min_digits) && pos > 1);
+    if (negative) {
+        tmp[--pos] = '-';
+    }
+    json_raw(w, &tmp[pos], sizeof(tmp) - pos);
+}
+
+void json_put_str(json_writer_t *w, const char *value)
+{
+    json_before_value(w);
+    json_string(w, value != NULL ? value : "");
+}
+
+void json_put_uint(json_writer_t *w, uint32_t value)
+{
+    json_before_value(w);
+    // Los valores de 32 bits bastan en el caso normal y evitan la división
+    // de 64 bits por software
+    char tmp[10];
+    size_t pos = sizeof(tmp);
+    do {
+        tmp[--pos] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    json_raw(w, &tmp[pos], sizeof(tmp) - pos);
+}
+
+void json_put_int(json_writer_t *w, int32_t value)
+{
+    if (value >= 0) {
+        json_put_uint(w, (uint32_t)value);
+        return;
+    }
+    json_before_value(w);
+    json_char(w, '-');
+    uint32_t magnitude = 0u - (uint32_t)value;
+    char tmp[10];
+    size_t pos = sizeof(tmp);
+    do {
+        tmp[--pos] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    json_raw(w, &tmp[pos], sizeof(tmp) - pos);
+}
+
+void json_put_int64(json_writer_t *w, int64_t value)
+{
+    json_before_value(w);
+    bool negative = value < 0;
+    json_digits(w, negative, negative ? 0u - (uint64_t)value : (uint64_t)value, 1);
+}
+
+void json_put_fixed(json_writer_t *w, int32_t value, uint8_t decimals)
+{
+    if (decimals == 0) {
+        json_put_int(w, value);
+        return;
+    }
+    json_before_value(w);
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    bool negative = value < 0;
+    uint32_t magnitude = negative ? 0u - (uint32_t)value : (uint32_t)value;
+    json_digits(w, negative, magnitude / scale, 1);
+    json_char(w, '.');
+    json_digits(w, false, magnitude % scale, decimals);
+}
+
+void json_put_bool(json_writer_t *w, bool value)
+{
+    json_before_value(w);
+    if (value) {
+        json_raw(w, "true", 4);
+    } else {
+        json_raw(w, "false", 5);
+    }
+}
+
+void json_put_null(json_writer_t *w)
+{
+    json_before_value(w);
+    json_raw(w, "null", 4);
+}
+
+void json_kv_str(json_writer_t *w, const char *key, const char *value)
+{
+    json_key(w, key);
+    json_put_str(w, value);
+}
+
+void json_kv_int(json_writer_t *w, const char *key, int32_t value)
+{
+    json_key(w, key);
+    json_put_int(w, value);
+}
+
+void json_kv_uint(json_writer_t *w, const char *key, uint32_t value)
+{
+    json_key(w, key);
+    json_put_uint(w, value);
+}
+
+void json_kv_fixed(json_writer_t *w, const char *key, int32_t value, uint8_t decimals)
+{
+    json_key(w, key);
+    json_put_fixed(w, value, decimals);
+}
+
+void json_kv_bool(json_writer_t *w, const char *key, bool value)
+{
+    json_key(w, key);
+    json_put_bool(w, value);
+}
+
+void json_writer_reset_buffer(json_writer_t *w)
+{
+    w->len = 0;
+}
+
+size_t json_writer_finish(json_writer_t *w)
+{
+    if (w->overflow || w->depth != 0) {
+        if (w->size > 0) {
+            w->buf[0] = '\0';
+        }
+        return 0;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
+
+#ifdef JSON_WRITER_BENCHMARK
+#include <stdio.h>
+#include "esp_log.h"
+#include "esp_cpu.h"
+
+#define JSON_BENCH_ITERATIONS 200
+
+static const char *TAG = "JSON_BENCH";
+
+// Mismo documento que /status, con valores fijos
+void json_writer_benchmark(void)
+{
+    char buf[256];
+    volatile float temperature = 23.5f;
+    volatile float humidity = 61.0f;
+    volatile int16_t temperature_x10 = 235;
+    volatile uint16_t humidity_x10 = 610;
+    size_t len_printf = 0;
+    size_t len_writer = 0;
+    
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < JSON_BENCH_ITERATIONS; i++) {
+        len_printf = snprintf(buf, sizeof(buf),
+                 "{\"led_state\":%s,\"button_state\":%s,\"press_count\":%lu,\"ip_address\":\"%s\",\"rssi\":%d,\"temperature\":%.1f,\"humidity\":%.1f,\"sensor_valid\":%s}",
+                 "true", "false", (unsigned long)1234, "192.168.1.50", -61,
+                 temperature, humidity, "true");
+    }
+    uint32_t cycles_printf = (esp_cpu_get_cycle_count() - start) / JSON_BENCH_ITERATIONS;
+    
+    start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < JSON_BENCH_ITERATIONS; i++) {
+        json_writer_t w;
+        json_writer_init(&w, buf, sizeof(buf));
+        json_obj_begin(&w);
+        json_kv_bool(&w, "led_state", true);
+        json_kv_bool(&w, "button_state", false);
+        json_kv_uint(&w, "press_count", 1234);
+        json_kv_str(&w, "ip_address", "192.168.1.50");
+        json_kv_int(&w, "rssi", -61);
+        json_kv_fixed(&w, "temperature", temperature_x10, 1);
+        json_kv_fixed(&w, "humidity", humidity_x10, 1);
+        json_kv_bool(&w, "sensor_valid", true);
+        json_obj_end(&w);
+        len_writer = json_writer_finish(&w);
+    }
+    uint32_t cycles_writer = (esp_cpu_get_cycle_count() - start) / JSON_BENCH_ITERATIONS;
+    
+    ESP_LOGI(TAG, "snprintf %%.1f: %lu ciclos/serialización (%u bytes)",
+             cycles_printf, (unsigned)len_printf);
+    ESP_LOGI(TAG, "json_writer:   %lu ciclos/serialización (%u bytes)",
+             cycles_writer, (unsigned)len_writer);
+}
+#endif
\ No newline at end of file
@@ -9,90 +9,112 @@
 #include "hardware.h"
 #include "wifi_config.h"
 #include "web_server.h"
-#include "nvs_flash.h"
-#include "mqtt_client.h"
+#include "ui.h"
+#include "mqtt_app.h"
+#include "telemetry.h"
+#include "json_writer.h"
+#include "scheduler.h"
+#include "power.h"
 
 static const char *TAG = "MAIN";
-static esp_mqtt_client_handle_t mqtt_client = NULL;
 
-// Manejador de eventos MQTT
-static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
-{
-    esp_mqtt_event_handle_t event = event_data;
-    
-    switch (event->event_id) {
-        case MQTT_EVENT_CONNECTED:
-            ESP_LOGI(TAG, "MQTT Conectado al broker");
-            // Suscribirse a tópicos si es necesario
-            esp_mqtt_client_subscribe(event->client, "test/server/cmd", 0);
-            break;
-            
-        case MQTT_EVENT_DISCONNECTED:
-            ESP_LOGI(TAG, "MQTT Desconectado del broker");
-            break;
-            
-        case MQTT_EVENT_SUBSCRIBED:
-            ESP_LOGI(TAG, "MQTT Suscrito al tópico, msg_id=%d", event->msg_id);
-            break;
-            
-        case MQTT_EVENT_UNSUBSCRIBED:
-            ESP_LOGI(TAG, "MQTT Desuscrito del tópico, msg_id=%d", event->msg_id);
-            break;
-            
-        case MQTT_EVENT_PUBLISHED:
-            ESP_LOGI(TAG, "MQTT Mensaje publicado, msg_id=%d", event->msg_id);
-            break;
-            
-        case MQTT_EVENT_DATA:
-            ESP_LOGI(TAG, "MQTT Datos recibidos");
-            printf("TOPIC=%.*s\r\n", event->topic_len, event->topic);
-            printf("DATA=%.*s\r\n", event->data_len, event->data);
-            break;
-            
-        case MQTT_EVENT_ERROR:
-            ESP_LOGE(TAG, "MQTT Error");
-            if (event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) {
-                ESP_LOGE(TAG, "Error de última conexión al broker = %d", event->error_handle->esp_transport_sock_errno);
-                ESP_LOGE(TAG, "Reporte detallado del error = %s", strerror(event->error_handle->esp_transport_sock_errno));
-            }
-            break;
-            
-        default:
-            ESP_LOGI(TAG, "Otro evento MQTT id:%d", event->event_id);
-            break;
+// Ritmo de los trabajos del planificador. Las fases (en app_main) los
+// reparten dentro de cada segundo para que no despierten todos a la vez.
+#define MAIN_SENSOR_PERIOD_MS       5000    // Lectura del DHT11
+#define MAIN_UI_PERIOD_MS           1000    // El botón redibuja en el acto
+#define MAIN_TELEMETRY_PERIOD_MS    1000
+#define MAIN_MQTT_PERIOD_MS         1000    // Vaciado de la cola: MQTT_BACKLOG_INTERVAL_MS
+#define MAIN_WEB_PUSH_PERIOD_MS     1000    // El botón empuja en el acto
+#define MAIN_STATS_PERIOD_MS        300000  // Jitter de los trabajos en el log
+
+static const ui_screen_t *s_screen = NULL;
+static int s_job_ui = -1;
+static int s_job_telemetry = -1;
+static int s_job_mqtt = -1;
+static int s_job_button = -1;
+static int s_job_web_push = -1;
+
+static void sensor_job(void *ctx) {
+    hardware_request_sensor_read();
+}
+
+static void ui_job(void *ctx) {
+    // Redibujar la pantalla solo si cambió algo de lo que muestra; lo que
+    // el tope de refresco aplace se dibuja en cuanto se pueda
+    if (!ui_poll() && ui_is_dirty()) {
+        scheduler_run_in(s_job_ui, UI_MIN_REFRESH_MS);
     }
 }
 
-// Función para inicializar el cliente MQTT
-static void mqtt_init(void)
-{
-    esp_mqtt_client_config_t mqtt_cfg = {
-        .broker.address.transport = MQTT_TRANSPORT_OVER_TCP,
-        .broker.address.hostname = "37.27.243.58",
-        .broker.address.port = 1883,
-        .session.protocol_ver = MQTT_PROTOCOL_V_3_1_1,
-        .session.keepalive = 60,
-        .credentials.client_id = "ESP32C3_CLIENT"
-    };
-    
-    mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
-    if (mqtt_client == NULL) {
-        ESP_LOGE(TAG, "Error al crear el cliente MQTT");
-        return;
+static void rssi_job(void *ctx) {
+    // Lo comparten la pantalla y /status
+    wifi_refresh_rssi();
+}
+
+static void telemetry_job(void *ctx) {
+    // Publicar solo cambios relevantes (y un latido en reposo)
+    telemetry_poll();
+}
+
+static void mqtt_job(void *ctx) {
+    // Vaciar la cola persistente a ritmo acotado
+    if (mqtt_app_poll()) {
+        scheduler_run_in(s_job_mqtt, MQTT_BACKLOG_INTERVAL_MS);
     }
+}
+
+static void web_push_job(void *ctx) {
+    // Estado a los paneles web abiertos (/ws), solo si cambió
+    web_server_push_changes();
+}
+
+static void stats_job(void *ctx) {
+    scheduler_log_stats();
+    web_server_log_stats();
     
-    esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
-    esp_err_t err = esp_mqtt_client_start(mqtt_client);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error al iniciar el cliente MQTT: %s", esp_err_to_name(err));
+    uint32_t presented, coalesced;
+    oled_get_frame_stats(&presented, &coalesced);
+    ESP_LOGI(TAG, "OLED: %lu fotogramas presentados, %lu fusionados", presented, coalesced);
+}
+
+static void power_job(void *ctx) {
+    power_update();
+}
+
+// Gestos del botón: el contador y el LED ya los gestiona hardware.c
+static void button_job(void *ctx) {
+    button_event_t event;
+    while (button_get_event(&event)) {
+        if (event.type == BUTTON_EVENT_DOUBLE_PRESS) {
+            s_screen = s_screen == &UI_SCREEN_BUTTON_DEBUG ? &UI_SCREEN_COMBINED_STATUS : &UI_SCREEN_BUTTON_DEBUG;
+            ui_set_screen(s_screen);
+        } else if (event.type == BUTTON_EVENT_LONG_PRESS) {
+            mqtt_app_flush(MQTT_BATCH_TELEMETRY);
+        }
     }
+    // Pantalla, telemetría y paneles web reflejan el cambio sin esperar a su turno
+    scheduler_run_in(s_job_ui, 0);
+    scheduler_run_in(s_job_telemetry, 0);
+    scheduler_run_in(s_job_web_push, 0);
+}
+
+// Llamado desde button_task
+static void button_listener(void) {
+    scheduler_run_in(s_job_button, 0);
 }
+
 void app_main(void)
 {
     ESP_LOGI(TAG, "📡 Iniciando Sistema ESP32-C3");
     
-    // 1. Inicializar hardware
+    // 1. Inicializar hardware y modo de bajo consumo
     hardware_init();
+    power_init();
+    
+#ifdef JSON_WRITER_BENCHMARK
+    // Compilar con -DJSON_WRITER_BENCHMARK para medir la serialización
+    json_writer_benchmark();
+#endif
     i2c_master_init();
     oled_init();
     oled_show_welcome_screen();
@@ -131,45 +153,27 @@ void app_main(void)
         vTaskDelay(8000 / portTICK_PERIOD_MS);
     }
     
-    // 4. Inicializar MQTT después de la conexión WiFi
-    if (wifi_ok) {
-        ESP_LOGI(TAG, "🔄 Iniciando cliente MQTT...");
-        mqtt_init();
-    }
+    // 4. Inicializar MQTT. Se arranca aunque el WiFi aún no esté listo: las
+    // muestras se guardan en flash y se envían al reconectar.
+    ESP_LOGI(TAG, "🔄 Iniciando cliente MQTT...");
+    mqtt_app_start();
     
-    // 5. Bucle principal
-    ESP_LOGI(TAG, "🔄 Iniciando bucle principal...");
+    // 5. Trabajos periódicos: el planificador duerme hasta el siguiente
+    ESP_LOGI(TAG, "🔄 Iniciando planificador...");
+    s_screen = &UI_SCREEN_BUTTON_DEBUG;
+    ui_set_screen(s_screen);
     
-    uint32_t last_mqtt_publish = 0;
-    char mqtt_data[128];
+    scheduler_init();
+    scheduler_add_periodic("sensor", sensor_job, NULL, MAIN_SENSOR_PERIOD_MS, 0, 50);
+    s_job_ui = scheduler_add_periodic("ui", ui_job, NULL, MAIN_UI_PERIOD_MS, 100, 50);
+    s_job_telemetry = scheduler_add_periodic("telemetry", telemetry_job, NULL, MAIN_TELEMETRY_PERIOD_MS, 300, 100);
+    s_job_mqtt = scheduler_add_periodic("mqtt", mqtt_job, NULL, MAIN_MQTT_PERIOD_MS, 600, 200);
+    s_job_web_push = scheduler_add_periodic("web_push", web_push_job, NULL, MAIN_WEB_PUSH_PERIOD_MS, 800, 100);
+    scheduler_add_periodic("rssi", rssi_job, NULL, WIFI_RSSI_SAMPLE_MS, 2600, 500);
+    scheduler_add_periodic("stats", stats_job, NULL, MAIN_STATS_PERIOD_MS, 4900, 0);
+    scheduler_add_periodic("power", power_job, NULL, POWER_STATS_PERIOD_MS, 5900, 0);
+    s_job_button = scheduler_add_oneshot("button", button_job, NULL, 5);
+    button_set_listener(button_listener);
     
-    while(1) {
-        hardware_update();
-        
-        // Mostrar estado actual
-        oled_show_button_debug(button_read(), led_get_state());
-        
-        // Publicar datos cada 5 segundos si MQTT está disponible
-        uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        if (mqtt_client && wifi_ok && (now - last_mqtt_publish >= 5000)) {
-            // Preparar datos en formato JSON
-            snprintf(mqtt_data, sizeof(mqtt_data),
-                    "{\"led\":%d,\"button\":%d,\"temperature\":%.1f,\"humidity\":%.1f,\"sensor_valid\":%d}",
-                    led_get_state(),
-                    button_read(),
-                    hardware_get_temperature(),
-                    hardware_get_humidity(),
-                    hardware_sensor_valid());
-                    
-            // Publicar en el topic
-            int msg_id = esp_mqtt_client_publish(mqtt_client, "test/server", mqtt_data, 0, 1, 0);
-            if (msg_id != -1) {
-                ESP_LOGI(TAG, "Mensaje MQTT enviado: %s", mqtt_data);
-            }
-            
-            last_mqtt_publish = now;
-        }
-        
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-    }
+    scheduler_run();
 }
\ No newline at end of file
@@ -0,0 +1,472 @@
+#include "mqtt_app.h"
+#include "telemetry_queue.h"
+#include "cbor_writer.h"
+#include "mqtt_router.h"
+#include "mqtt_commands.h"
+#include "mqtt_inflight.h"
+#include "mqtt_client.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+#include <string.h>
+
+static const char *TAG = "MQTT";
+
+static esp_mqtt_client_handle_t s_client = NULL;
+static volatile bool s_connected = false;
+
+// Delimitadores de un array en cada formato
+typedef struct {
+    uint8_t open;
+    uint8_t separator;      // 0 = sin separador
+    uint8_t close;
+} mqtt_framing_t;
+
+static const mqtt_framing_t s_framing[MQTT_FORMAT_COUNT] = {
+    [MQTT_FORMAT_JSON] = { '[', ',', ']' },
+    [MQTT_FORMAT_CBOR] = { CBOR_ARRAY_INDEFINITE, 0, CBOR_BREAK },
+};
+
+// Lote en RAM de un tópico. buf contiene la apertura del array y las
+// muestras (con separador en JSON); el cierre se añade al enviarlo.
+// starts/lens permiten volcar las muestras una a una a la cola persistente
+// si no se puede publicar.
+typedef struct {
+    const char *topic;
+    mqtt_format_t format;
+    int qos;
+    uint8_t max_samples;
+    uint32_t max_age_ms;
+    bool persist;           // Guardar en flash si no hay conexión
+    
+    uint8_t buf[MQTT_BATCH_BUF_BYTES];
+    size_t len;
+    uint8_t count;
+    uint16_t starts[MQTT_BATCH_MAX_SAMPLES];
+    uint16_t lens[MQTT_BATCH_MAX_SAMPLES];
+    uint32_t first_ms;
+} mqtt_batch_t;
+
+static mqtt_batch_t s_batches[MQTT_BATCH_COUNT] = {
+    [MQTT_BATCH_TELEMETRY] = {
+        .topic = MQTT_TOPIC_TELEMETRY,
+        .format = MQTT_TELEMETRY_FORMAT,
+        .qos = 1,
+        .max_samples = MQTT_TELEMETRY_BATCH_SAMPLES,
+        .max_age_ms = MQTT_TELEMETRY_BATCH_MAX_MS,
+        .persist = true,
+    },
+};
+static SemaphoreHandle_t s_batch_mutex = NULL;
+static uint32_t s_deferred = 0;     // Lotes desviados a flash por falta de cupo
+static uint32_t s_dropped = 0;      // Muestras perdidas sin remedio
+
+// Lote de recuperación en vuelo. Solo hay uno a la vez: la cola se confirma
+// al recibir su PUBACK, de modo que un corte a mitad reenvía el lote entero
+// (entrega al menos una vez, nunca se pierde una muestra confirmada).
+static telemetry_queue_cursor_t s_backlog_cursor;
+static volatile int s_backlog_msg_id = -1;
+static volatile bool s_backlog_acked = false;
+// Últimos PUBACK recibidos. El evento puede llegar antes de que
+// esp_mqtt_client_publish() devuelva el msg_id: quien llega segundo (el
+// manejador o mqtt_app_poll) ve lo que dejó el otro y marca el lote.
+#define MQTT_RECENT_ACKS 8
+static volatile int s_recent_acks[MQTT_RECENT_ACKS];
+static volatile uint8_t s_recent_ack_next = 0;
+static uint32_t s_backlog_sent_ms = 0;
+static uint32_t s_backlog_last_ms = 0;
+static uint8_t s_backlog_buf[MQTT_BACKLOG_BATCH_BYTES];
+static uint8_t s_record_buf[TELEMETRY_QUEUE_MAX_RECORD];
+
+static uint32_t mqtt_now_ms(void)
+{
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+// Manejador de eventos MQTT
+static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    esp_mqtt_event_handle_t event = event_data;
+    
+    switch (event->event_id) {
+        case MQTT_EVENT_CONNECTED:
+            ESP_LOGI(TAG, "MQTT Conectado al broker");
+            s_connected = true;
+            // Una sola suscripción; mqtt_router reparte por tópico
+            esp_mqtt_client_subscribe(event->client, MQTT_TOPIC_CMD_FILTER, 1);
+            break;
+            
+        case MQTT_EVENT_DISCONNECTED:
+            ESP_LOGI(TAG, "MQTT Desconectado del broker");
+            s_connected = false;
+            // El lote en vuelo se reenviará completo al reconectar
+            s_backlog_acked = false;
+            break;
+            
+        case MQTT_EVENT_SUBSCRIBED:
+            ESP_LOGI(TAG, "MQTT Suscrito al tópico, msg_id=%d", event->msg_id);
+            break;
+            
+        case MQTT_EVENT_UNSUBSCRIBED:
+            ESP_LOGI(TAG, "MQTT Desuscrito del tópico, msg_id=%d", event->msg_id);
+            break;
+            
+        case MQTT_EVENT_PUBLISHED:
+            ESP_LOGD(TAG, "MQTT Mensaje publicado, msg_id=%d", event->msg_id);
+            s_recent_acks[s_recent_ack_next] = event->msg_id;
+            s_recent_ack_next = (s_recent_ack_next + 1) % MQTT_RECENT_ACKS;
+            if (event->msg_id == s_backlog_msg_id) {
+                s_backlog_acked = true;
+            }
+            mqtt_inflight_ack(event->msg_id);
+            break;
+            
+        case MQTT_EVENT_DELETED:
+            // esp-mqtt descartó un mensaje del outbox sin recibir su PUBACK.
+            // No entrega el contenido, así que un lote de telemetría no
+            // puede volver a la cola: sus muestras se suman a "dropped".
+            ESP_LOGW(TAG, "MQTT Mensaje expirado en el outbox, msg_id=%d", event->msg_id);
+            mqtt_inflight_expire_msg(event->msg_id);
+            break;
+            
+        case MQTT_EVENT_DATA:
+            // Se despacha en la propia tarea de MQTT para actuar sin esperas
+            mqtt_router_feed(event->topic, event->topic_len, event->data, event->data_len,
+                             event->current_data_offset, event->total_data_len);
+            break;
+            
+        case MQTT_EVENT_ERROR:
+            ESP_LOGE(TAG, "MQTT Error");
+            if (event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) {
+                ESP_LOGE(TAG, "Error de última conexión al broker = %d", event->error_handle->esp_transport_sock_errno);
+                ESP_LOGE(TAG, "Reporte detallado del error = %s", strerror(event->error_handle->esp_transport_sock_errno));
+            }
+            break;
+            
+        default:
+            ESP_LOGI(TAG, "Otro evento MQTT id:%d", event->event_id);
+            break;
+    }
+}
+
+// Envía el lote completo en un único PUBLISH. Si no hay conexión, o hay
+// cola pendiente y enviarlo ahora adelantaría muestras más recientes, las
+// muestras pasan una a una a la cola persistente. Llamar con el mutex tomado.
+static void mqtt_batch_flush_locked(mqtt_batch_t *batch, bool allow_publish)
+{
+    if (batch->count == 0) {
+        return;
+    }
+    
+    bool sent = false;
+    if (allow_publish && mqtt_app_is_connected() &&
+        (!batch->persist || telemetry_queue_pending() == 0)) {
+        // Con el broker atascado el lote no entra en el outbox: se desvía a
+        // flash (o se descarta) en vez de acumularse en el heap
+        // El lote solo vive en el outbox: si esp-mqtt lo expira sin PUBACK
+        // sus muestras cuentan como perdidas
+        int slot = mqtt_inflight_admit(MQTT_CLASS_TELEMETRY, batch->len + 1, batch->count);
+        if (slot >= 0) {
+            batch->buf[batch->len] = s_framing[batch->format].close;
+            int msg_id = esp_mqtt_client_publish(s_client, batch->topic, (const char *)batch->buf,
+                                                 batch->len + 1, batch->qos, 0);
+            // -1 es un error y -2 un outbox lleno: en ambos casos el lote
+            // no salió y debe pasar a la cola persistente
+            if (msg_id >= 0 && batch->qos > 0) {
+                mqtt_inflight_track(slot, msg_id);
+            } else {
+                mqtt_inflight_cancel(slot);
+            }
+            if (msg_id >= 0) {
+                ESP_LOGI(TAG, "Lote de %u muestras enviado a %s (%u bytes)",
+                         batch->count, batch->topic, (unsigned)(batch->len + 1));
+                sent = true;
+            }
+        } else {
+            s_deferred++;
+            ESP_LOGW(TAG, "Sin cupo en vuelo para %s, lote aplazado", batch->topic);
+        }
+    }
+    
+    if (!sent && batch->persist) {
+        for (uint8_t i = 0; i < batch->count; i++) {
+            esp_err_t err = telemetry_queue_push(&batch->buf[batch->starts[i]], batch->lens[i]);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "No se pudo guardar la muestra: %s", esp_err_to_name(err));
+                s_dropped++;
+            }
+        }
+        ESP_LOGI(TAG, "Lote no enviado: %u muestras guardadas (%lu pendientes)",
+                 batch->count, telemetry_queue_pending());
+    } else if (!sent) {
+        ESP_LOGW(TAG, "Lote de %s descartado sin conexión", batch->topic);
+        s_dropped += batch->count;
+    }
+    
+    batch->len = 0;
+    batch->count = 0;
+}
+
+// Al reiniciar no da tiempo a recibir un PUBACK: lo que quede en RAM se
+// guarda en flash y sale por el backlog tras el arranque
+static void mqtt_app_shutdown_handler(void)
+{
+    if (s_batch_mutex == NULL || xSemaphoreTake(s_batch_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return;
+    }
+    for (int i = 0; i < MQTT_BATCH_COUNT; i++) {
+        mqtt_batch_flush_locked(&s_batches[i], false);
+    }
+    xSemaphoreGive(s_batch_mutex);
+}
+
+mqtt_format_t mqtt_app_get_format(mqtt_batch_id_t id)
+{
+    return id < MQTT_BATCH_COUNT ? s_batches[id].format : MQTT_FORMAT_JSON;
+}
+
+void mqtt_app_publish_sample(mqtt_batch_id_t id, const void *data, size_t len, bool urgent)
+{
+    if (id >= MQTT_BATCH_COUNT || s_batch_mutex == NULL) {
+        return;
+    }
+    mqtt_batch_t *batch = &s_batches[id];
+    const mqtt_framing_t *framing = &s_framing[batch->format];
+    // Apertura + muestra + cierre debe caber aunque el lote esté vacío
+    if (len + 2 > sizeof(batch->buf)) {
+        ESP_LOGW(TAG, "Muestra demasiado grande para %s (%u bytes)", batch->topic, (unsigned)len);
+        return;
+    }
+    
+    xSemaphoreTake(s_batch_mutex, portMAX_DELAY);
+    
+    // Separador + muestra + cierre
+    if (batch->count > 0 && batch->len + 1 + len + 1 > sizeof(batch->buf)) {
+        mqtt_batch_flush_locked(batch, true);
+    }
+    if (batch->count == 0) {
+        batch->buf[0] = framing->open;
+        batch->len = 1;
+        batch->first_ms = mqtt_now_ms();
+    } else if (framing->separator) {
+        batch->buf[batch->len++] = framing->separator;
+    }
+    batch->starts[batch->count] = batch->len;
+    batch->lens[batch->count] = len;
+    memcpy(&batch->buf[batch->len], data, len);
+    batch->len += len;
+    batch->count++;
+    
+    if (urgent || batch->count >= batch->max_samples || batch->count >= MQTT_BATCH_MAX_SAMPLES) {
+        mqtt_batch_flush_locked(batch, true);
+    }
+    
+    xSemaphoreGive(s_batch_mutex);
+}
+
+void mqtt_app_flush(mqtt_batch_id_t id)
+{
+    if (id >= MQTT_BATCH_COUNT || s_batch_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_batch_mutex, portMAX_DELAY);
+    mqtt_batch_flush_locked(&s_batches[id], true);
+    xSemaphoreGive(s_batch_mutex);
+}
+
+void mqtt_app_start(void)
+{
+    s_batch_mutex = xSemaphoreCreateMutex();
+    esp_register_shutdown_handler(mqtt_app_shutdown_handler);
+    mqtt_commands_init();
+    
+    // La cola funciona aunque el broker no esté disponible todavía
+    esp_err_t err = telemetry_queue_init();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Cola persistente no disponible: %s", esp_err_to_name(err));
+    }
+    
+    esp_mqtt_client_config_t mqtt_cfg = {
+        .broker.address.transport = MQTT_TRANSPORT_OVER_TCP,
+        .broker.address.hostname = MQTT_BROKER_HOST,
+        .broker.address.port = MQTT_BROKER_PORT,
+        .session.protocol_ver = MQTT_PROTOCOL_V_3_1_1,
+        .session.keepalive = 60,
+        .credentials.client_id = MQTT_CLIENT_ID,
+        // Tope duro del outbox; el control fino lo hace mqtt_inflight
+        .outbox.limit = MQTT_OUTBOX_LIMIT_BYTES,
+    };
+    
+    s_client = esp_mqtt_client_init(&mqtt_cfg);
+    if (s_client == NULL) {
+        ESP_LOGE(TAG, "Error al crear el cliente MQTT");
+        return;
+    }
+    
+    esp_mqtt_client_register_event(s_client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+    err = esp_mqtt_client_start(s_client);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error al iniciar el cliente MQTT: %s", esp_err_to_name(err));
+    }
+}
+
+bool mqtt_app_is_connected(void)
+{
+    return s_client != NULL && s_connected;
+}
+
+int mqtt_app_publish_response(const char *topic, const char *data, size_t len)
+{
+    if (!mqtt_app_is_connected()) {
+        return -1;
+    }
+    int slot = mqtt_inflight_admit(MQTT_CLASS_COMMAND, len, 0);
+    if (slot < 0) {
+        return -1;
+    }
+    int msg_id = esp_mqtt_client_publish(s_client, topic, data, len, 1, 0);
+    mqtt_inflight_track(slot, msg_id);     // Con msg_id <= 0 libera la reserva
+    return msg_id < 0 ? -1 : msg_id;       // -2 (outbox lleno) también es un fallo
+}
+
+void mqtt_app_get_stats(mqtt_app_stats_t *out)
+{
+    telemetry_queue_stats_t queue;
+    telemetry_queue_get_stats(&queue);
+    
+    out->connected = mqtt_app_is_connected();
+    mqtt_inflight_get_stats(&out->inflight);
+    out->outbox_bytes = s_client != NULL ? esp_mqtt_client_get_outbox_size(s_client) : 0;
+    out->deferred = s_deferred;
+    out->dropped = s_dropped + queue.dropped + out->inflight.lost_samples;
+    out->backlog_pending = queue.pending;
+}
+
+// Un registro JSON siempre empieza por '{'; uno CBOR por una cabecera de map
+static mqtt_format_t mqtt_record_format(const uint8_t *record, size_t len)
+{
+    return (len > 0 && record[0] == '{') ? MQTT_FORMAT_JSON : MQTT_FORMAT_CBOR;
+}
+
+// Empaqueta registros consecutivos del mismo formato en un array hasta
+// llenar el buffer. Al cambiar de formato (p. ej. tras una actualización)
+// el lote se corta y el resto sale en el siguiente.
+static size_t mqtt_build_backlog_batch(void)
+{
+    size_t pos = 1;
+    const mqtt_framing_t *framing = NULL;
+    telemetry_queue_cursor_init(&s_backlog_cursor);
+    
+    while (true) {
+        telemetry_queue_cursor_t before = s_backlog_cursor;
+        size_t len = 0;
+        if (telemetry_queue_read(&s_backlog_cursor, s_record_buf, sizeof(s_record_buf), &len) != ESP_OK) {
+            break;
+        }
+        const mqtt_framing_t *record_framing = &s_framing[mqtt_record_format(s_record_buf, len)];
+        // Separador + registro + cierre
+        if (pos + 1 + len + 1 > sizeof(s_backlog_buf) ||
+            (framing != NULL && record_framing != framing)) {
+            s_backlog_cursor = before;
+            break;
+        }
+        if (framing == NULL) {
+            framing = record_framing;
+            s_backlog_buf[0] = framing->open;
+        } else if (framing->separator) {
+            s_backlog_buf[pos++] = framing->separator;
+        }
+        memcpy(&s_backlog_buf[pos], s_record_buf, len);
+        pos += len;
+    }
+    
+    if (framing == NULL) {
+        // No había nada que enviar salvo registros descartados (p. ej. uno
+        // corrupto por un corte de alimentación a mitad de escritura): se
+        // retiran de la cola para no tropezar con ellos en cada intento
+        if (s_backlog_cursor.skipped > 0) {
+            ESP_LOGW(TAG, "%lu registros no válidos retirados de la cola", s_backlog_cursor.skipped);
+            telemetry_queue_consume(&s_backlog_cursor);
+        }
+        return 0;
+    }
+    s_backlog_buf[pos++] = framing->close;
+    return pos;
+}
+
+bool mqtt_app_poll(void)
+{
+    uint32_t now = mqtt_now_ms();
+    
+    mqtt_inflight_expire_old();
+    
+    // Cerrar los lotes que superan su antigüedad máxima
+    if (s_batch_mutex != NULL) {
+        xSemaphoreTake(s_batch_mutex, portMAX_DELAY);
+        for (int i = 0; i < MQTT_BATCH_COUNT; i++) {
+            mqtt_batch_t *batch = &s_batches[i];
+            if (batch->count > 0 && now - batch->first_ms >= batch->max_age_ms) {
+                mqtt_batch_flush_locked(batch, true);
+            }
+        }
+        xSemaphoreGive(s_batch_mutex);
+    }
+    
+    if (!mqtt_app_is_connected()) {
+        // Lo no confirmado se reenvía completo al reconectar
+        s_backlog_msg_id = -1;
+        return false;
+    }
+    
+    if (s_backlog_msg_id != -1) {
+        if (s_backlog_acked) {
+            esp_err_t err = telemetry_queue_consume(&s_backlog_cursor);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "No se pudo confirmar el lote: %s", esp_err_to_name(err));
+            }
+            ESP_LOGI(TAG, "Lote de %lu muestras entregado (%lu pendientes)",
+                     s_backlog_cursor.records - s_backlog_cursor.skipped, telemetry_queue_pending());
+            s_backlog_msg_id = -1;
+        } else if (now - s_backlog_sent_ms >= MQTT_BACKLOG_ACK_TIMEOUT_MS) {
+            ESP_LOGW(TAG, "Lote sin PUBACK, se reenviará");
+            s_backlog_msg_id = -1;
+        } else {
+            return true;    // Esperando el PUBACK del lote
+        }
+    }
+    
+    if (telemetry_queue_pending() == 0) {
+        return false;
+    }
+    if (now - s_backlog_last_ms < MQTT_BACKLOG_INTERVAL_MS) {
+        return true;
+    }
+    s_backlog_last_ms = now;
+    
+    size_t len = mqtt_build_backlog_batch();
+    if (len == 0) {
+        return true;
+    }
+    // Sin PUBACK el lote sigue en flash y se reenvía: no hay pérdida
+    int slot = mqtt_inflight_admit(MQTT_CLASS_BACKLOG, len, 0);
+    if (slot < 0) {
+        return true;
+    }
+    
+    int msg_id = esp_mqtt_client_publish(s_client, MQTT_TOPIC_BACKLOG, (const char *)s_backlog_buf, len, 1, 0);
+    mqtt_inflight_track(slot, msg_id);
+    if (msg_id < 0) {
+        return true;    // Error u outbox lleno: se reintenta en el siguiente intervalo
+    }
+    s_backlog_sent_ms = now;
+    s_backlog_acked = false;
+    s_backlog_msg_id = msg_id;
+    for (int i = 0; i < MQTT_RECENT_ACKS; i++) {
+        if (s_recent_acks[i] == msg_id) {
+            s_backlog_acked = true;     // El PUBACK llegó antes que el msg_id
+        }
+    }
+    return true;
+}
\ No newline at end of file
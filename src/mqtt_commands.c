@@ -0,0 +1,330 @@
+#include "mqtt_commands.h"
+#include "mqtt_app.h"
+#include "mqtt_router.h"
+#include "json_reader.h"
+#include "json_writer.h"
+#include "hardware.h"
+#include "telemetry.h"
+#include "sensor_history.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "MQTT_CMD";
+
+// Campos que entienden los comandos. Solo cuentan las claves del objeto
+// raíz: lo anidado se recorre para validarlo pero no se interpreta.
+typedef enum {
+    CMD_FIELD_NONE = 0,
+    CMD_FIELD_ID,
+    CMD_FIELD_ACTION,
+    CMD_FIELD_HEARTBEAT,
+    CMD_FIELD_TEMP_DEADBAND,
+    CMD_FIELD_HUMIDITY_DEADBAND,
+    CMD_FIELD_TIER,
+    CMD_FIELD_FROM,
+    CMD_FIELD_TO,
+    CMD_FIELD_LIMIT,
+    CMD_FIELD_COUNT
+} cmd_field_t;
+
+static const char *const s_cmd_keys[CMD_FIELD_COUNT] = {
+    [CMD_FIELD_ID]                = "id",
+    [CMD_FIELD_ACTION]            = "action",
+    [CMD_FIELD_HEARTBEAT]         = "heartbeat_s",
+    [CMD_FIELD_TEMP_DEADBAND]     = "temp_deadband",
+    [CMD_FIELD_HUMIDITY_DEADBAND] = "humidity_deadband",
+    [CMD_FIELD_TIER]              = "tier",
+    [CMD_FIELD_FROM]              = "from",
+    [CMD_FIELD_TO]                = "to",
+    [CMD_FIELD_LIMIT]             = "limit",
+};
+
+typedef struct {
+    char id[MQTT_CMD_ID_MAX];
+    bool has[CMD_FIELD_COUNT];
+    int32_t values[CMD_FIELD_COUNT];
+    cmd_field_t field;          // A qué campo va el próximo valor
+    const char *error;
+} cmd_request_t;
+
+// Callback de json_reader: el documento debe ser un objeto; los valores de
+// las claves conocidas se validan al llegar (igual que POST /led)
+static bool cmd_parse_token(void *ctx, const json_token_t *tok)
+{
+    cmd_request_t *q = (cmd_request_t *)ctx;
+    cmd_field_t field = q->field;
+    q->field = CMD_FIELD_NONE;
+    
+    if (tok->depth == 0 && tok->type != JSON_TOK_OBJ_BEGIN && tok->type != JSON_TOK_OBJ_END) {
+        q->error = "se esperaba un objeto JSON";
+        return false;
+    }
+    if (tok->type == JSON_TOK_KEY) {
+        if (tok->depth == 1) {
+            for (int i = CMD_FIELD_NONE + 1; i < CMD_FIELD_COUNT; i++) {
+                if (strcmp(tok->text, s_cmd_keys[i]) == 0) {
+                    q->field = i;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+    if (field == CMD_FIELD_NONE) {
+        return true;
+    }
+    
+    switch (field) {
+        case CMD_FIELD_ID:
+            if (tok->type != JSON_TOK_STRING) {
+                q->error = "id no válido";
+                return false;
+            }
+            snprintf(q->id, sizeof(q->id), "%s", tok->text);
+            break;
+        case CMD_FIELD_ACTION:
+            q->values[field] = led_action_from_token(tok);
+            if (q->values[field] < 0) {
+                q->error = "acción no válida";
+                return false;
+            }
+            break;
+        case CMD_FIELD_TIER:
+            q->values[field] = -1;
+            for (int t = 0; tok->type == JSON_TOK_STRING && t < SENSOR_TIER_COUNT; t++) {
+                if (strcmp(tok->text, sensor_history_tier_name(t)) == 0) {
+                    q->values[field] = t;
+                }
+            }
+            if (q->values[field] < 0) {
+                q->error = "tier no válido";
+                return false;
+            }
+            break;
+        default:
+            if (!json_token_to_int(tok, &q->values[field])) {
+                q->error = "valor no válido";
+                return false;
+            }
+            break;
+    }
+    q->has[field] = true;
+    return true;
+}
+
+// Valida el payload completo con json_reader. Devuelve false con q->error
+// si no es un objeto JSON bien formado o algún campo conocido no vale; el
+// id se conserva si llegó antes del error para poder responder con él.
+static bool cmd_parse(const char *payload, size_t len, cmd_request_t *q)
+{
+    memset(q, 0, sizeof(*q));
+    json_reader_t reader;
+    json_reader_init(&reader, cmd_parse_token, q);
+    json_reader_feed(&reader, payload, len);
+    if (!json_reader_finish(&reader)) {
+        if (q->error == NULL) {
+            q->error = json_reader_error_str(reader.error);
+        }
+        return false;
+    }
+    return true;
+}
+
+static bool cmd_is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Abre la respuesta con el id (si lo hay) y el nombre del comando
+static void cmd_response_begin(json_writer_t *w, char *buf, size_t size, const char *id, const char *cmd)
+{
+    json_writer_init(w, buf, size);
+    json_obj_begin(w);
+    if (id[0] != '\0') {
+        json_kv_str(w, "id", id);
+    }
+    json_kv_str(w, "cmd", cmd);
+}
+
+static void cmd_response_send(json_writer_t *w)
+{
+    json_obj_end(w);
+    size_t len = json_writer_finish(w);
+    if (len > 0) {
+        mqtt_app_publish_response(MQTT_TOPIC_RESP, w->buf, len);
+    }
+}
+
+static void cmd_led_handler(const char *topic, const char *payload, size_t len, void *ctx)
+{
+    cmd_request_t q;
+    
+    while (len > 0 && cmd_is_space(*payload)) {
+        payload++;
+        len--;
+    }
+    if (len > 0 && payload[0] == '{') {
+        if (cmd_parse(payload, len, &q) && !q.has[CMD_FIELD_ACTION]) {
+            q.error = "falta action";
+        }
+    } else {
+        // Texto plano: on / off / toggle / 0 / 1 / 2 (con o sin salto de
+        // línea), con los mismos valores que "action"
+        memset(&q, 0, sizeof(q));
+        while (len > 0 && cmd_is_space(payload[len - 1])) len--;
+        char word[8];
+        if (len >= sizeof(word)) len = 0;
+        memcpy(word, payload, len);
+        word[len] = '\0';
+        q.values[CMD_FIELD_ACTION] = led_action_from_text(word);
+        if (q.values[CMD_FIELD_ACTION] < 0) {
+            q.error = "acción no válida";
+        }
+    }
+    
+    if (q.error == NULL) {
+        led_apply_action(q.values[CMD_FIELD_ACTION]);
+    }
+    ESP_LOGI(TAG, "LED id=%s %s -> %d", q.id, q.error ? q.error : "ok", led_get_state());
+    
+    char buf[128];
+    json_writer_t w;
+    cmd_response_begin(&w, buf, sizeof(buf), q.id, "led");
+    json_kv_bool(&w, "ok", q.error == NULL);
+    if (q.error != NULL) {
+        json_kv_str(&w, "error", q.error);
+    }
+    json_kv_bool(&w, "led_state", led_get_state());
+    cmd_response_send(&w);
+}
+
+static void cmd_config_handler(const char *topic, const char *payload, size_t len, void *ctx)
+{
+    cmd_request_t q;
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+    if (cmd_parse(payload, len, &q)) {
+        // Partir de la configuración actual: solo cambian los campos presentes
+        telemetry_config_t config;
+        telemetry_get_config(&config);
+        if (q.has[CMD_FIELD_HEARTBEAT]) {
+            // Fuera de rango queda en 0 y telemetry_set_config() lo rechaza
+            int32_t value = q.values[CMD_FIELD_HEARTBEAT];
+            config.heartbeat_ms = (value > 0 && value <= TELEMETRY_HEARTBEAT_MAX_MS / 1000) ? (uint32_t)value * 1000 : 0;
+        }
+        if (q.has[CMD_FIELD_TEMP_DEADBAND]) {
+            config.temp_deadband_x10 = q.values[CMD_FIELD_TEMP_DEADBAND];
+        }
+        if (q.has[CMD_FIELD_HUMIDITY_DEADBAND]) {
+            config.humidity_deadband_x10 = q.values[CMD_FIELD_HUMIDITY_DEADBAND];
+        }
+        bool changed = q.has[CMD_FIELD_HEARTBEAT] || q.has[CMD_FIELD_TEMP_DEADBAND] ||
+                       q.has[CMD_FIELD_HUMIDITY_DEADBAND];
+        err = changed ? telemetry_set_config(&config) : ESP_OK;
+        if (err != ESP_OK) {
+            q.error = "valor fuera de rango";
+        }
+    }
+    
+    // La respuesta siempre refleja la configuración vigente
+    telemetry_config_t config;
+    telemetry_get_config(&config);
+    char buf[160];
+    json_writer_t w;
+    cmd_response_begin(&w, buf, sizeof(buf), q.id, "config");
+    json_kv_bool(&w, "ok", err == ESP_OK);
+    if (err != ESP_OK) {
+        json_kv_str(&w, "error", q.error);
+    }
+    json_kv_uint(&w, "heartbeat_s", config.heartbeat_ms / 1000);
+    json_kv_int(&w, "temp_deadband", config.temp_deadband_x10);
+    json_kv_int(&w, "humidity_deadband", config.humidity_deadband_x10);
+    cmd_response_send(&w);
+}
+
+// Una página del histórico. La respuesta no cabe en la pila de la tarea de
+// MQTT (única que llama a los handlers), así que los buffers son estáticos.
+static void cmd_history_handler(const char *topic, const char *payload, size_t len, void *ctx)
+{
+    static sensor_rollup_t points[MQTT_CMD_HISTORY_MAX_POINTS + 1];
+    static char buf[160 + MQTT_CMD_HISTORY_MAX_POINTS * 48];
+    
+    cmd_request_t q;
+    if (cmd_parse(payload, len, &q)) {
+        if ((q.has[CMD_FIELD_FROM] && q.values[CMD_FIELD_FROM] < 0) ||
+            (q.has[CMD_FIELD_TO] && q.values[CMD_FIELD_TO] < 0) ||
+            (q.has[CMD_FIELD_LIMIT] && (q.values[CMD_FIELD_LIMIT] <= 0 ||
+                                        q.values[CMD_FIELD_LIMIT] > MQTT_CMD_HISTORY_MAX_POINTS))) {
+            q.error = "valor fuera de rango";
+        }
+    }
+    
+    sensor_tier_t tier = q.has[CMD_FIELD_TIER] ? q.values[CMD_FIELD_TIER] : SENSOR_TIER_RAW;
+    uint32_t from = q.has[CMD_FIELD_FROM] ? (uint32_t)q.values[CMD_FIELD_FROM] : 0;
+    uint32_t to = q.has[CMD_FIELD_TO] ? (uint32_t)q.values[CMD_FIELD_TO] : UINT32_MAX;
+    size_t limit = q.has[CMD_FIELD_LIMIT] ? (size_t)q.values[CMD_FIELD_LIMIT] : MQTT_CMD_HISTORY_MAX_POINTS;
+    size_t n = 0;
+    bool more = false;
+    if (q.error == NULL) {
+        // Un punto de más indica si hay otra página sin hacer otra consulta
+        n = sensor_history_query(tier, from, to, points, limit + 1);
+        more = n > limit;
+        if (more) n = limit;
+    }
+    
+    json_writer_t w;
+    cmd_response_begin(&w, buf, sizeof(buf), q.id, "history");
+    json_kv_bool(&w, "ok", q.error == NULL);
+    if (q.error != NULL) {
+        json_kv_str(&w, "error", q.error);
+        cmd_response_send(&w);
+        return;
+    }
+    json_kv_str(&w, "tier", sensor_history_tier_name(tier));
+    json_kv_uint(&w, "period", sensor_history_tier_period(tier));
+    // Mismo formato de punto que GET /history
+    json_key(&w, "points");
+    json_arr_begin(&w);
+    for (size_t i = 0; i < n; i++) {
+        const sensor_rollup_t *p = &points[i];
+        json_arr_begin(&w);
+        json_put_uint(&w, p->start_s);
+        json_put_int(&w, p->temp_min_x10);
+        json_put_int(&w, p->temp_max_x10);
+        json_put_int(&w, p->temp_avg_x10);
+        json_put_uint(&w, p->hum_min_x10);
+        json_put_uint(&w, p->hum_max_x10);
+        json_put_uint(&w, p->hum_avg_x10);
+        json_arr_end(&w);
+    }
+    json_arr_end(&w);
+    if (more) {
+        json_kv_uint(&w, "next", points[n - 1].start_s + 1);
+    }
+    cmd_response_send(&w);
+    ESP_LOGI(TAG, "Histórico id=%s %s: %u puntos%s", q.id, sensor_history_tier_name(tier),
+             (unsigned)n, more ? " (hay más)" : "");
+}
+
+static void cmd_unknown_handler(const char *topic, const char *payload, size_t len, void *ctx)
+{
+    // Solo interesa el id; un payload no válido responde sin él
+    cmd_request_t q;
+    cmd_parse(payload, len, &q);
+    ESP_LOGW(TAG, "Comando desconocido en %s", topic);
+    
+    char buf[128];
+    json_writer_t w;
+    cmd_response_begin(&w, buf, sizeof(buf), q.id, topic);
+    json_kv_bool(&w, "ok", false);
+    json_kv_str(&w, "error", "comando desconocido");
+    cmd_response_send(&w);
+}
+
+void mqtt_commands_init(void)
+{
+    ESP_ERROR_CHECK(mqtt_router_add(MQTT_TOPIC_CMD_LED, cmd_led_handler, NULL, false));
+    ESP_ERROR_CHECK(mqtt_router_add(MQTT_TOPIC_CMD_CONFIG, cmd_config_handler, NULL, false));
+    ESP_ERROR_CHECK(mqtt_router_add(MQTT_TOPIC_CMD_HISTORY, cmd_history_handler, NULL, false));
+    ESP_ERROR_CHECK(mqtt_router_add(MQTT_TOPIC_CMD_FILTER, cmd_unknown_handler, NULL, true));
+}
\ No newline at end of file
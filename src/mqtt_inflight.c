@@ -0,0 +1,207 @@
+#include "mqtt_inflight.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+static const char *TAG = "MQTT_INFLIGHT";
+
+#define MQTT_INFLIGHT_RESERVED  -1
+
+typedef struct {
+    int msg_id;             // 0 = libre (esp-mqtt nunca usa 0 con QoS 1), -1 = reservado
+    mqtt_class_t cls;
+    uint16_t bytes;
+    uint16_t samples;       // Se pierden si el mensaje expira
+    int64_t sent_us;
+} mqtt_inflight_entry_t;
+
+// Parte del cupo que puede ocupar cada clase. Lo que no usa una clase
+// inferior queda libre para las superiores.
+typedef struct {
+    uint8_t max_msgs;
+    uint16_t max_bytes;
+} mqtt_class_limit_t;
+
+static const mqtt_class_limit_t s_limits[MQTT_CLASS_COUNT] = {
+    [MQTT_CLASS_COMMAND]   = { MQTT_INFLIGHT_MAX,         MQTT_INFLIGHT_MAX_BYTES },
+    [MQTT_CLASS_TELEMETRY] = { MQTT_INFLIGHT_MAX * 3 / 4, MQTT_INFLIGHT_MAX_BYTES * 3 / 4 },
+    [MQTT_CLASS_BACKLOG]   = { MQTT_INFLIGHT_MAX / 2,     MQTT_INFLIGHT_MAX_BYTES / 2 },
+};
+
+// Se usa desde la tarea de MQTT (PUBACK) y desde las que publican
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static mqtt_inflight_entry_t s_entries[MQTT_INFLIGHT_MAX];
+static mqtt_inflight_stats_t s_stats;
+
+// PUBACK que llegaron antes de mqtt_inflight_track(): esp-mqtt puede
+// entregar el evento antes de que esp_mqtt_client_publish() devuelva
+static int s_early_acks[MQTT_INFLIGHT_MAX];
+static uint8_t s_early_ack_next = 0;
+
+int mqtt_inflight_admit(mqtt_class_t cls, size_t bytes, uint16_t samples)
+{
+    if (cls >= MQTT_CLASS_COUNT) {
+        return -1;
+    }
+    uint16_t size = bytes > UINT16_MAX ? UINT16_MAX : bytes;
+    int slot = -1;
+    portENTER_CRITICAL(&s_mux);
+    if (s_stats.inflight < s_limits[cls].max_msgs &&
+        s_stats.inflight_bytes + size <= s_limits[cls].max_bytes) {
+        for (int i = 0; i < MQTT_INFLIGHT_MAX; i++) {
+            if (s_entries[i].msg_id == 0) {
+                slot = i;
+                break;
+            }
+        }
+    }
+    if (slot >= 0) {
+        s_entries[slot] = (mqtt_inflight_entry_t) {
+            .msg_id = MQTT_INFLIGHT_RESERVED,
+            .cls = cls,
+            .bytes = size,
+            .samples = samples,
+            .sent_us = esp_timer_get_time(),
+        };
+        s_stats.inflight++;
+        s_stats.inflight_bytes += size;
+        if (s_stats.inflight > s_stats.max_inflight) {
+            s_stats.max_inflight = s_stats.inflight;
+        }
+    } else {
+        s_stats.rejected[cls]++;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    return slot;
+}
+
+static void mqtt_inflight_free(int slot)
+{
+    s_stats.inflight--;
+    s_stats.inflight_bytes -= s_entries[slot].bytes;
+    s_entries[slot].msg_id = 0;
+}
+
+void mqtt_inflight_cancel(int slot)
+{
+    if (slot < 0 || slot >= MQTT_INFLIGHT_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&s_mux);
+    if (s_entries[slot].msg_id == MQTT_INFLIGHT_RESERVED) {
+        mqtt_inflight_free(slot);
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+static void mqtt_inflight_count_ack(int64_t sent_us, int64_t now)
+{
+    uint32_t ms = (uint32_t)((now - sent_us) / 1000);
+    s_stats.acked++;
+    s_stats.puback_last_ms = ms;
+    s_stats.puback_avg_ms = s_stats.acked == 1 ? ms
+        : s_stats.puback_avg_ms + ((int32_t)ms - (int32_t)s_stats.puback_avg_ms) / 8;
+    if (ms > s_stats.puback_max_ms) {
+        s_stats.puback_max_ms = ms;
+    }
+}
+
+void mqtt_inflight_track(int slot, int msg_id)
+{
+    if (slot < 0 || slot >= MQTT_INFLIGHT_MAX) {
+        return;
+    }
+    if (msg_id <= 0) {
+        mqtt_inflight_cancel(slot);
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_mux);
+    if (s_entries[slot].msg_id == MQTT_INFLIGHT_RESERVED) {
+        s_entries[slot].msg_id = msg_id;
+        for (int i = 0; i < MQTT_INFLIGHT_MAX; i++) {
+            if (s_early_acks[i] == msg_id) {
+                s_early_acks[i] = 0;
+                mqtt_inflight_count_ack(s_entries[slot].sent_us, now);
+                mqtt_inflight_free(slot);
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+// Libera la entrada del msg_id y devuelve cuándo se envió, o -1. Si
+// samples no es NULL recibe las muestras que llevaba.
+static int64_t mqtt_inflight_release(int msg_id, uint16_t *samples)
+{
+    int64_t sent_us = -1;
+    for (int i = 0; i < MQTT_INFLIGHT_MAX; i++) {
+        if (s_entries[i].msg_id == msg_id) {
+            sent_us = s_entries[i].sent_us;
+            if (samples != NULL) {
+                *samples = s_entries[i].samples;
+            }
+            mqtt_inflight_free(i);
+            break;
+        }
+    }
+    return sent_us;
+}
+
+void mqtt_inflight_ack(int msg_id)
+{
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_mux);
+    int64_t sent_us = mqtt_inflight_release(msg_id, NULL);
+    if (sent_us >= 0) {
+        mqtt_inflight_count_ack(sent_us, now);
+    } else if (msg_id > 0) {
+        // Aún reservado sin msg_id: lo resolverá mqtt_inflight_track()
+        s_early_acks[s_early_ack_next] = msg_id;
+        s_early_ack_next = (s_early_ack_next + 1) % MQTT_INFLIGHT_MAX;
+    }
+    portEXIT_CRITICAL(&s_mux);
+}
+
+void mqtt_inflight_expire_msg(int msg_id)
+{
+    uint16_t samples = 0;
+    portENTER_CRITICAL(&s_mux);
+    if (mqtt_inflight_release(msg_id, &samples) >= 0) {
+        s_stats.expired++;
+        s_stats.lost_samples += samples;
+    }
+    portEXIT_CRITICAL(&s_mux);
+    if (samples > 0) {
+        ESP_LOGW(TAG, "Mensaje %d expirado: %u muestras perdidas", msg_id, samples);
+    }
+}
+
+void mqtt_inflight_expire_old(void)
+{
+    int64_t limit = esp_timer_get_time() - (int64_t)MQTT_INFLIGHT_TIMEOUT_MS * 1000;
+    uint32_t expired = 0;
+    portENTER_CRITICAL(&s_mux);
+    for (int i = 0; i < MQTT_INFLIGHT_MAX; i++) {
+        if (s_entries[i].msg_id != 0 && s_entries[i].sent_us < limit) {
+            s_stats.lost_samples += s_entries[i].samples;
+            mqtt_inflight_free(i);
+            expired++;
+        }
+    }
+    s_stats.timeouts += expired;
+    portEXIT_CRITICAL(&s_mux);
+    if (expired > 0) {
+        ESP_LOGW(TAG, "%lu mensajes sin PUBACK en %d ms (broker lento o sin conexión)",
+                 expired, MQTT_INFLIGHT_TIMEOUT_MS);
+    }
+}
+
+void mqtt_inflight_get_stats(mqtt_inflight_stats_t *out)
+{
+    portENTER_CRITICAL(&s_mux);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_mux);
+}
\ No newline at end of file
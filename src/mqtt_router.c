@@ -0,0 +1,213 @@
+#include "mqtt_router.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "MQTT_ROUTER";
+
+typedef struct {
+    const char *pattern;
+    mqtt_route_handler_t handler;
+    void *ctx;
+    bool fallback;
+} mqtt_route_t;
+
+// Nodo del trie: un nivel del patrón. Los hijos forman una lista enlazada
+// por índices dentro del pool estático.
+typedef struct {
+    const char *level;      // Apunta dentro del patrón registrado
+    uint8_t level_len;
+    int8_t first_child;
+    int8_t next_sibling;
+    int8_t route;           // Ruta que termina en este nivel, o -1
+} mqtt_trie_node_t;
+
+static mqtt_route_t s_routes[MQTT_ROUTER_MAX_ROUTES];
+static size_t s_route_count = 0;
+static mqtt_trie_node_t s_nodes[MQTT_ROUTER_MAX_NODES] = {
+    [0] = { .level = "", .level_len = 0, .first_child = -1, .next_sibling = -1, .route = -1 },
+};
+static size_t s_node_count = 1;    // El 0 es la raíz
+
+// Reensamblado de mensajes fragmentados. Solo lo usa la tarea de esp-mqtt.
+static char s_topic[MQTT_ROUTER_MAX_TOPIC];
+static char s_payload[MQTT_ROUTER_MAX_PAYLOAD + 1];
+static int s_received = 0;
+static bool s_discarding = false;
+
+static bool level_equals(const mqtt_trie_node_t *node, const char *level, size_t len)
+{
+    return node->level_len == len && memcmp(node->level, level, len) == 0;
+}
+
+static int trie_child(int parent, const char *level, size_t len, bool create)
+{
+    for (int c = s_nodes[parent].first_child; c >= 0; c = s_nodes[c].next_sibling) {
+        if (level_equals(&s_nodes[c], level, len)) {
+            return c;
+        }
+    }
+    if (!create || s_node_count >= MQTT_ROUTER_MAX_NODES || len > UINT8_MAX) {
+        return -1;
+    }
+    int n = s_node_count++;
+    s_nodes[n] = (mqtt_trie_node_t) {
+        .level = level,
+        .level_len = len,
+        .first_child = -1,
+        .next_sibling = s_nodes[parent].first_child,
+        .route = -1,
+    };
+    s_nodes[parent].first_child = n;
+    return n;
+}
+
+esp_err_t mqtt_router_add(const char *pattern, mqtt_route_handler_t handler, void *ctx, bool fallback)
+{
+    if (pattern == NULL || handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_route_count >= MQTT_ROUTER_MAX_ROUTES) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Validar antes de tocar el trie: '#' solo como último nivel y los
+    // comodines ocupan el nivel entero
+    for (const char *level = pattern; level != NULL; ) {
+        const char *slash = strchr(level, '/');
+        size_t len = slash ? (size_t)(slash - level) : strlen(level);
+        bool wildcard = memchr(level, '+', len) || memchr(level, '#', len);
+        if ((wildcard && len != 1) || (level[0] == '#' && slash != NULL)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        level = slash ? slash + 1 : NULL;
+    }
+    
+    int node = 0;
+    for (const char *level = pattern; level != NULL; ) {
+        const char *slash = strchr(level, '/');
+        size_t len = slash ? (size_t)(slash - level) : strlen(level);
+        node = trie_child(node, level, len, true);
+        if (node < 0) {
+            ESP_LOGE(TAG, "Sin nodos libres para %s", pattern);
+            return ESP_ERR_NO_MEM;
+        }
+        level = slash ? slash + 1 : NULL;
+    }
+    
+    if (s_nodes[node].route >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_nodes[node].route = s_route_count;
+    s_routes[s_route_count++] = (mqtt_route_t) {
+        .pattern = pattern,
+        .handler = handler,
+        .ctx = ctx,
+        .fallback = fallback,
+    };
+    return ESP_OK;
+}
+
+// Recorre el trie siguiendo los niveles del tópico. Cada nodo puede
+// coincidir por nivel literal, por '+' o por '#'. Las rutas encontradas se
+// acumulan en matches (sin repetir: cada nodo se visita una vez por camino).
+static void trie_match(int node, const char *level, const char *end, bool has_level,
+                       int8_t *matches, size_t *count)
+{
+    // '#' cubre este nivel y todos los siguientes, incluido ninguno
+    int hash = trie_child(node, "#", 1, false);
+    if (hash >= 0 && s_nodes[hash].route >= 0 && *count < MQTT_ROUTER_MAX_ROUTES) {
+        matches[(*count)++] = s_nodes[hash].route;
+    }
+    
+    if (!has_level) {
+        if (s_nodes[node].route >= 0 && *count < MQTT_ROUTER_MAX_ROUTES) {
+            matches[(*count)++] = s_nodes[node].route;
+        }
+        return;
+    }
+    
+    const char *slash = memchr(level, '/', end - level);
+    size_t len = slash ? (size_t)(slash - level) : (size_t)(end - level);
+    const char *next = slash ? slash + 1 : end;
+    
+    for (int c = s_nodes[node].first_child; c >= 0; c = s_nodes[c].next_sibling) {
+        const mqtt_trie_node_t *child = &s_nodes[c];
+        if ((child->level_len == 1 && child->level[0] == '+') || level_equals(child, level, len)) {
+            trie_match(c, next, end, slash != NULL, matches, count);
+        }
+    }
+}
+
+int mqtt_router_dispatch(const char *topic, const char *payload, size_t len)
+{
+    int8_t matches[MQTT_ROUTER_MAX_ROUTES];
+    size_t count = 0;
+    size_t topic_len = strlen(topic);
+    
+    // Los tópicos de sistema ($SYS/...) no coinciden con comodines iniciales;
+    // aquí simplemente no se despachan
+    if (topic[0] != '$') {
+        trie_match(0, topic, topic + topic_len, true, matches, &count);
+    }
+    
+    int called = 0;
+    for (size_t i = 0; i < count; i++) {
+        const mqtt_route_t *route = &s_routes[matches[i]];
+        if (!route->fallback) {
+            route->handler(topic, payload, len, route->ctx);
+            called++;
+        }
+    }
+    if (called == 0) {
+        for (size_t i = 0; i < count; i++) {
+            const mqtt_route_t *route = &s_routes[matches[i]];
+            if (route->fallback) {
+                route->handler(topic, payload, len, route->ctx);
+                called++;
+            }
+        }
+    }
+    if (called == 0) {
+        ESP_LOGW(TAG, "Sin ruta para %s", topic);
+    }
+    return called;
+}
+
+void mqtt_router_feed(const char *topic, int topic_len, const char *data, int data_len,
+                      int offset, int total_len)
+{
+    // El primer trozo trae el tópico; los siguientes solo datos
+    if (offset == 0) {
+        s_received = 0;
+        s_discarding = false;
+        if (topic_len <= 0 || topic_len >= (int)sizeof(s_topic)) {
+            ESP_LOGW(TAG, "Tópico no válido (%d bytes)", topic_len);
+            s_discarding = true;
+        } else if (total_len > MQTT_ROUTER_MAX_PAYLOAD) {
+            ESP_LOGW(TAG, "Mensaje demasiado grande (%d bytes), descartado", total_len);
+            s_discarding = true;
+        } else {
+            memcpy(s_topic, topic, topic_len);
+            s_topic[topic_len] = '\0';
+        }
+    }
+    if (s_discarding) {
+        return;
+    }
+    if (offset != s_received || offset + data_len > total_len) {
+        // Trozo fuera de orden: se pierde el mensaje entero
+        ESP_LOGW(TAG, "Fragmento inesperado en %s (offset %d, esperado %d)", s_topic, offset, s_received);
+        s_discarding = true;
+        return;
+    }
+    
+    memcpy(&s_payload[offset], data, data_len);
+    s_received += data_len;
+    if (s_received < total_len) {
+        return;
+    }
+    
+    s_payload[s_received] = '\0';
+    mqtt_router_dispatch(s_topic, s_payload, s_received);
+    s_received = 0;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "driver/i2c.h"
 #include "esp_log.h"
@@ -10,6 +11,9 @@
 
 static const char *TAG = "OLED";
 
+// Prioridad de la tarea de pantalla (por encima de app_main)
+#define OLED_TASK_PRIORITY          3
+
 // Comandos SSD1306
 #define SSD1306_DISPLAYOFF          0xAE
 #define SSD1306_DISPLAYON           0xAF
@@ -30,33 +34,141 @@ static const char *TAG = "OLED";
 #define SSD1306_COLUMNADDR          0x21
 #define SSD1306_PAGEADDR            0x22
 
-// Buffer para la pantalla
-static uint8_t oled_buffer[SCREEN_WIDTH * (SCREEN_HEIGHT / 8)];
+// Buffer de dibujo (back buffer): las primitivas oled_draw_* escriben aquí
+static uint8_t oled_buffer[SCREEN_WIDTH * OLED_PAGES];
 
-// Función privada para escribir comandos
-static void oled_write_cmd(uint8_t cmd) {
-    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
-    i2c_master_start(cmd_handle);
-    i2c_master_write_byte(cmd_handle, (OLED_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd_handle, 0x00, true);
-    i2c_master_write_byte(cmd_handle, cmd, true);
-    i2c_master_stop(cmd_handle);
-    i2c_master_cmd_begin(I2C_MASTER_NUM, cmd_handle, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd_handle);
+// Último fotograma presentado (front buffer), pendiente de envío por la tarea
+static uint8_t s_front_buffer[SCREEN_WIDTH * OLED_PAGES];
+
+// Copia de lo que contiene la RAM del panel; solo la usa la tarea de pantalla
+static uint8_t s_panel_buffer[SCREEN_WIDTH * OLED_PAGES];
+static uint8_t s_panel_valid_pages = 0;
+
+// Rango de columnas modificado por página. Una página está limpia cuando x0 > x1.
+typedef struct {
+    uint8_t x0[OLED_PAGES];
+    uint8_t x1[OLED_PAGES];
+} oled_dirty_t;
+
+static oled_dirty_t s_back_dirty;   // cambios en oled_buffer desde el último present
+static oled_dirty_t s_front_dirty;  // cambios en s_front_buffer aún no enviados
+
+// Tarea que posee el bus I2C y envía los fotogramas presentados
+static TaskHandle_t s_display_task = NULL;
+static SemaphoreHandle_t s_front_mutex = NULL;
+static volatile int s_pending_power = -1;
+static uint32_t s_frames_presented = 0;
+static uint32_t s_frames_coalesced = 0;
+
+static inline void oled_mark_dirty(oled_dirty_t *dirty, int page, int x0, int x1) {
+    if (x0 < dirty->x0[page]) dirty->x0[page] = x0;
+    if (x1 > dirty->x1[page]) dirty->x1[page] = x1;
+}
+
+static inline void oled_mark_clean(oled_dirty_t *dirty, int page) {
+    dirty->x0[page] = 0xFF;
+    dirty->x1[page] = 0;
+}
+
+static inline bool oled_page_dirty(const oled_dirty_t *dirty, int page) {
+    return dirty->x0[page] <= dirty->x1[page];
 }
 
-// Función privada para escribir datos
-static void oled_write_data(uint8_t *data, size_t len) {
-    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create();
+static void oled_mark_all_dirty(oled_dirty_t *dirty) {
+    for (int page = 0; page < OLED_PAGES; page++) {
+        dirty->x0[page] = 0;
+        dirty->x1[page] = SCREEN_WIDTH - 1;
+    }
+}
+
+// Tiempo máximo que una transacción puede ocupar el bus
+#define OLED_I2C_TIMEOUT_MS         1000
+
+// Bytes de control SSD1306 (Co = continuación, D/C# = datos/comando)
+#define SSD1306_CTRL_CMD_STREAM     0x00
+#define SSD1306_CTRL_CMD_SINGLE     0x80
+#define SSD1306_CTRL_DATA_STREAM    0x40
+
+// Operaciones máximas de una transacción: start, cabecera, datos, stop
+#define OLED_I2C_LINK_OPS           4
+
+// Ejecuta una transacción I2C de escritura: cabecera + carga opcional.
+// El enlace de comandos vive en la pila para no pasar por el heap.
+static esp_err_t oled_i2c_write(const uint8_t *header, size_t header_len,
+                                const uint8_t *payload, size_t payload_len) {
+    uint8_t link_buf[I2C_LINK_RECOMMENDED_SIZE(OLED_I2C_LINK_OPS)];
+    i2c_cmd_handle_t cmd_handle = i2c_cmd_link_create_static(link_buf, sizeof(link_buf));
+    if (cmd_handle == NULL) return ESP_ERR_NO_MEM;
+
     i2c_master_start(cmd_handle);
-    i2c_master_write_byte(cmd_handle, (OLED_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd_handle, 0x40, true);
-    i2c_master_write(cmd_handle, data, len, true);
+    i2c_master_write(cmd_handle, header, header_len, true);
+    if (payload_len > 0) {
+        i2c_master_write(cmd_handle, payload, payload_len, true);
+    }
     i2c_master_stop(cmd_handle);
-    i2c_master_cmd_begin(I2C_MASTER_NUM, cmd_handle, 1000 / portTICK_PERIOD_MS);
-    i2c_cmd_link_delete(cmd_handle);
+    esp_err_t ret = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd_handle,
+                                         OLED_I2C_TIMEOUT_MS / portTICK_PERIOD_MS);
+    i2c_cmd_link_delete_static(cmd_handle);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Error I2C: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void oled_cmd_begin(oled_cmd_batch_t *batch) {
+    batch->len = 0;
 }
 
+void oled_cmd_append(oled_cmd_batch_t *batch, uint8_t cmd) {
+    // Si el lote está lleno se envía lo acumulado y se continúa
+    if (batch->len >= OLED_CMD_BATCH_MAX) {
+        oled_cmd_commit(batch);
+    }
+    batch->cmds[batch->len++] = cmd;
+}
+
+esp_err_t oled_cmd_commit(oled_cmd_batch_t *batch) {
+    if (batch->len == 0) return ESP_OK;
+
+    // Un único byte de control 0x00 y todos los comandos a continuación
+    uint8_t header[2] = {
+        (OLED_ADDRESS << 1) | I2C_MASTER_WRITE,
+        SSD1306_CTRL_CMD_STREAM
+    };
+    esp_err_t ret = oled_i2c_write(header, sizeof(header), batch->cmds, batch->len);
+    batch->len = 0;
+    return ret;
+}
+
+// Función privada para escribir un comando suelto
+static void oled_write_cmd(uint8_t cmd) {
+    oled_cmd_batch_t batch;
+    oled_cmd_begin(&batch);
+    oled_cmd_append(&batch, cmd);
+    oled_cmd_commit(&batch);
+}
+
+// Función privada: fija la ventana de columnas/páginas y escribe los datos
+// en la misma transacción (comandos con Co=1 seguidos del flujo de datos)
+static esp_err_t oled_write_window(uint8_t col_start, uint8_t col_end,
+                                   uint8_t page_start, uint8_t page_end,
+                                   const uint8_t *data, size_t len) {
+    const uint8_t header[] = {
+        (OLED_ADDRESS << 1) | I2C_MASTER_WRITE,
+        SSD1306_CTRL_CMD_SINGLE, SSD1306_COLUMNADDR,
+        SSD1306_CTRL_CMD_SINGLE, col_start,
+        SSD1306_CTRL_CMD_SINGLE, col_end,
+        SSD1306_CTRL_CMD_SINGLE, SSD1306_PAGEADDR,
+        SSD1306_CTRL_CMD_SINGLE, page_start,
+        SSD1306_CTRL_CMD_SINGLE, page_end,
+        SSD1306_CTRL_DATA_STREAM
+    };
+    return oled_i2c_write(header, sizeof(header), data, len);
+}
+
+static void oled_display_task(void *arg);
+
 void i2c_master_init(void) {
     i2c_config_t conf = {
         .mode = I2C_MODE_MASTER,
@@ -74,52 +186,183 @@ void i2c_master_init(void) {
 void oled_init(void) {
     vTaskDelay(100 / portTICK_PERIOD_MS);
     
-    // Secuencia de inicialización para SSD1306 72x40
-    oled_write_cmd(SSD1306_DISPLAYOFF);
-    oled_write_cmd(SSD1306_SETDISPLAYCLOCKDIV);
-    oled_write_cmd(0x80);
-    oled_write_cmd(SSD1306_SETMULTIPLEX);
-    oled_write_cmd(0x27); // 39 = 0x27 (40-1)
-    oled_write_cmd(SSD1306_SETDISPLAYOFFSET);
-    oled_write_cmd(0x00);
-    oled_write_cmd(SSD1306_SETSTARTLINE | 0x00);
-    oled_write_cmd(SSD1306_CHARGEPUMP);
-    oled_write_cmd(0x14);
-    oled_write_cmd(SSD1306_MEMORYMODE);
-    oled_write_cmd(0x00);
-    oled_write_cmd(SSD1306_SEGREMAP | 0x01);
-    oled_write_cmd(SSD1306_COMSCANDEC);
-    oled_write_cmd(SSD1306_SETCOMPINS);
-    oled_write_cmd(0x12);
-    oled_write_cmd(SSD1306_SETCONTRAST);
-    oled_write_cmd(0xCF);
-    oled_write_cmd(SSD1306_SETPRECHARGE);
-    oled_write_cmd(0xF1);
-    oled_write_cmd(SSD1306_SETVCOMDETECT);
-    oled_write_cmd(0x40);
-    oled_write_cmd(SSD1306_DISPLAYALLON_RESUME);
-    oled_write_cmd(SSD1306_NORMALDISPLAY);
-    oled_write_cmd(SSD1306_DISPLAYON);
+    // Secuencia de inicialización para SSD1306 72x40 (una sola transacción)
+    oled_cmd_batch_t batch;
+    oled_cmd_begin(&batch);
+    oled_cmd_append(&batch, SSD1306_DISPLAYOFF);
+    oled_cmd_append(&batch, SSD1306_SETDISPLAYCLOCKDIV);
+    oled_cmd_append(&batch, 0x80);
+    oled_cmd_append(&batch, SSD1306_SETMULTIPLEX);
+    oled_cmd_append(&batch, 0x27); // 39 = 0x27 (40-1)
+    oled_cmd_append(&batch, SSD1306_SETDISPLAYOFFSET);
+    oled_cmd_append(&batch, 0x00);
+    oled_cmd_append(&batch, SSD1306_SETSTARTLINE | 0x00);
+    oled_cmd_append(&batch, SSD1306_CHARGEPUMP);
+    oled_cmd_append(&batch, 0x14);
+    oled_cmd_append(&batch, SSD1306_MEMORYMODE);
+    oled_cmd_append(&batch, 0x00);
+    oled_cmd_append(&batch, SSD1306_SEGREMAP | 0x01);
+    oled_cmd_append(&batch, SSD1306_COMSCANDEC);
+    oled_cmd_append(&batch, SSD1306_SETCOMPINS);
+    oled_cmd_append(&batch, 0x12);
+    oled_cmd_append(&batch, SSD1306_SETCONTRAST);
+    oled_cmd_append(&batch, 0xCF);
+    oled_cmd_append(&batch, SSD1306_SETPRECHARGE);
+    oled_cmd_append(&batch, 0xF1);
+    oled_cmd_append(&batch, SSD1306_SETVCOMDETECT);
+    oled_cmd_append(&batch, 0x40);
+    oled_cmd_append(&batch, SSD1306_DISPLAYALLON_RESUME);
+    oled_cmd_append(&batch, SSD1306_NORMALDISPLAY);
+    oled_cmd_append(&batch, SSD1306_DISPLAYON);
+    oled_cmd_commit(&batch);
+    
+    // El contenido de la RAM del panel es desconocido tras el arranque
+    s_panel_valid_pages = 0;
+    oled_mark_all_dirty(&s_back_dirty);
+    
+    if (s_display_task == NULL) {
+        s_front_mutex = xSemaphoreCreateMutex();
+        for (int page = 0; page < OLED_PAGES; page++) {
+            oled_mark_clean(&s_front_dirty, page);
+        }
+        BaseType_t t = xTaskCreate(oled_display_task, "oled_task", 3072, NULL,
+                                   OLED_TASK_PRIORITY, &s_display_task);
+        if (t != pdPASS) {
+            ESP_LOGE(TAG, "No se pudo crear tarea oled_task");
+            s_display_task = NULL;
+        }
+    }
     
     ESP_LOGI(TAG, "OLED 72x40 inicializado");
 }
 
 void oled_clear(void) {
     memset(oled_buffer, 0, sizeof(oled_buffer));
+    oled_mark_all_dirty(&s_back_dirty);
 }
 
+// Presenta el fotograma dibujado: copia los tramos modificados al front
+// buffer y despierta a la tarea de pantalla. No espera al bus I2C; si la
+// tarea va atrasada, los fotogramas intermedios se fusionan.
 void oled_update(void) {
-    oled_write_cmd(SSD1306_COLUMNADDR);
-    oled_write_cmd(X_OFFSET);
-    oled_write_cmd(X_OFFSET + SCREEN_WIDTH - 1);
-    oled_write_cmd(SSD1306_PAGEADDR);
-    oled_write_cmd(0);
-    oled_write_cmd((SCREEN_HEIGHT / 8) - 1);
-    oled_write_data(oled_buffer, sizeof(oled_buffer));
+    if (s_display_task == NULL) {
+        ESP_LOGW(TAG, "oled_update() antes de oled_init()");
+        return;
+    }
+    
+    bool changed = false;
+    xSemaphoreTake(s_front_mutex, portMAX_DELAY);
+    bool pending = false;
+    for (int page = 0; page < OLED_PAGES; page++) {
+        pending |= oled_page_dirty(&s_front_dirty, page);
+        if (!oled_page_dirty(&s_back_dirty, page)) continue;
+        
+        int x0 = s_back_dirty.x0[page];
+        int x1 = s_back_dirty.x1[page];
+        int offset = page * SCREEN_WIDTH + x0;
+        memcpy(&s_front_buffer[offset], &oled_buffer[offset], x1 - x0 + 1);
+        oled_mark_dirty(&s_front_dirty, page, x0, x1);
+        oled_mark_clean(&s_back_dirty, page);
+        changed = true;
+    }
+    if (changed) {
+        s_frames_presented++;
+        if (pending) s_frames_coalesced++;
+    }
+    xSemaphoreGive(s_front_mutex);
+    
+    if (changed) {
+        xTaskNotifyGive(s_display_task);
+    }
+}
+
+// Envía al panel los tramos pendientes del front buffer. Solo la llama la
+// tarea de pantalla; el mutex se mantiene únicamente durante las copias.
+static void oled_flush_front(void) {
+    uint8_t span_x0[OLED_PAGES];
+    uint8_t span_x1[OLED_PAGES];
+    
+    xSemaphoreTake(s_front_mutex, portMAX_DELAY);
+    for (int page = 0; page < OLED_PAGES; page++) {
+        int x0 = s_front_dirty.x0[page];
+        int x1 = s_front_dirty.x1[page];
+        oled_mark_clean(&s_front_dirty, page);
+        
+        const uint8_t *row = &s_front_buffer[page * SCREEN_WIDTH];
+        uint8_t *panel = &s_panel_buffer[page * SCREEN_WIDTH];
+        
+        // Recortar el tramo a los bytes que realmente difieren del panel
+        if (s_panel_valid_pages & (1 << page)) {
+            while (x0 <= x1 && row[x0] == panel[x0]) x0++;
+            while (x1 >= x0 && row[x1] == panel[x1]) x1--;
+        }
+        if (x0 <= x1) {
+            memcpy(&panel[x0], &row[x0], x1 - x0 + 1);
+        }
+        span_x0[page] = x0;
+        span_x1[page] = x1;
+    }
+    xSemaphoreGive(s_front_mutex);
+    
+    // Transferencias I2C fuera del mutex: el productor puede seguir presentando
+    for (int page = 0; page < OLED_PAGES; page++) {
+        int x0 = span_x0[page];
+        int x1 = span_x1[page];
+        if (x0 > x1) continue;
+        
+        esp_err_t ret = oled_write_window(X_OFFSET + x0, X_OFFSET + x1, page, page,
+                                          &s_panel_buffer[page * SCREEN_WIDTH + x0],
+                                          x1 - x0 + 1);
+        if (ret != ESP_OK) {
+            // Reintentar la página completa en el próximo envío
+            s_panel_valid_pages &= ~(1 << page);
+            xSemaphoreTake(s_front_mutex, portMAX_DELAY);
+            oled_mark_dirty(&s_front_dirty, page, 0, SCREEN_WIDTH - 1);
+            xSemaphoreGive(s_front_mutex);
+            continue;
+        }
+        
+        // Una página se vuelve válida cuando se ha escrito entera al menos una vez
+        if (x0 == 0 && x1 == SCREEN_WIDTH - 1) {
+            s_panel_valid_pages |= (1 << page);
+        }
+    }
+}
+
+static void oled_display_task(void *arg) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        int power = s_pending_power;
+        if (power >= 0) {
+            s_pending_power = -1;
+            oled_write_cmd(power ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+        }
+        
+        oled_flush_front();
+    }
 }
 
 void oled_set_power(int on) {
-    oled_write_cmd(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+    if (s_display_task == NULL) {
+        oled_write_cmd(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+        return;
+    }
+    s_pending_power = on ? 1 : 0;
+    xTaskNotifyGive(s_display_task);
+}
+
+void oled_get_frame_stats(uint32_t *presented, uint32_t *coalesced) {
+    // Antes de oled_init() no hay mutex ni fotogramas
+    if (s_front_mutex == NULL) {
+        if (presented) *presented = 0;
+        if (coalesced) *coalesced = 0;
+        return;
+    }
+    xSemaphoreTake(s_front_mutex, portMAX_DELAY);
+    if (presented) *presented = s_frames_presented;
+    if (coalesced) *coalesced = s_frames_coalesced;
+    xSemaphoreGive(s_front_mutex);
 }
 
 void oled_draw_pixel(int x, int y) {
@@ -128,9 +371,65 @@ void oled_draw_pixel(int x, int y) {
     int page = y / 8;
     int bit = y % 8;
     oled_buffer[x + page * SCREEN_WIDTH] |= (1 << bit);
+    oled_mark_dirty(&s_back_dirty, page, x, x);
+}
+
+// OR de 'count' columnas verticales de 8 bits a partir de (x, y). Cada byte
+// coincide con el formato de página del SSD1306 (bit 0 arriba), así que con
+// y múltiplo de 8 se copia directo y en otro caso se reparte en dos páginas.
+static void oled_blit_columns(int x, int y, const uint8_t *cols, int count) {
+    if (y >= SCREEN_HEIGHT || y <= -8) return;
+    
+    // Recorte horizontal
+    if (x < 0) {
+        cols -= x;
+        count += x;
+        x = 0;
+    }
+    if (x + count > SCREEN_WIDTH) count = SCREEN_WIDTH - x;
+    if (count <= 0) return;
+    
+    int page = y >> 3;      // -1 si y está entre -7 y -1
+    int shift = y & 7;
+    
+    if (shift == 0) {
+        uint8_t *row = &oled_buffer[page * SCREEN_WIDTH + x];
+        for (int i = 0; i < count; i++) row[i] |= cols[i];
+        oled_mark_dirty(&s_back_dirty, page, x, x + count - 1);
+        return;
+    }
+    
+    if (page >= 0) {
+        uint8_t *row = &oled_buffer[page * SCREEN_WIDTH + x];
+        for (int i = 0; i < count; i++) row[i] |= (uint8_t)(cols[i] << shift);
+        oled_mark_dirty(&s_back_dirty, page, x, x + count - 1);
+    }
+    if (page + 1 < OLED_PAGES) {
+        uint8_t *row = &oled_buffer[(page + 1) * SCREEN_WIDTH + x];
+        for (int i = 0; i < count; i++) row[i] |= cols[i] >> (8 - shift);
+        oled_mark_dirty(&s_back_dirty, page + 1, x, x + count - 1);
+    }
+}
+
+void oled_draw_hline(int x, int y, int w) {
+    oled_draw_fill_rect(x, y, w, 1);
+}
+
+void oled_draw_vline(int x, int y, int h) {
+    oled_draw_fill_rect(x, y, 1, h);
 }
 
 void oled_draw_line(int x0, int y0, int x1, int y1) {
+    // Líneas horizontales y verticales por máscara de página
+    if (y0 == y1) {
+        oled_draw_hline(x0 < x1 ? x0 : x1, y0, abs(x1 - x0) + 1);
+        return;
+    }
+    if (x0 == x1) {
+        oled_draw_vline(x0, y0 < y1 ? y0 : y1, abs(y1 - y0) + 1);
+        return;
+    }
+    
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
     int sx = (x0 < x1) ? 1 : -1;
@@ -153,25 +452,32 @@ void oled_draw_line(int x0, int y0, int x1, int y1) {
 }
 
 void oled_draw_rect(int x, int y, int w, int h) {
-    oled_draw_line(x, y, x + w, y);
-    oled_draw_line(x + w, y, x + w, y + h);
-    oled_draw_line(x + w, y + h, x, y + h);
-    oled_draw_line(x, y + h, x, y);
+    oled_draw_hline(x, y, w + 1);
+    oled_draw_hline(x, y + h, w + 1);
+    oled_draw_vline(x, y, h + 1);
+    oled_draw_vline(x + w, y, h + 1);
 }
 
 void oled_draw_fill_rect(int x, int y, int w, int h) {
-    for (int i = x; i < x + w; i++) {
-        for (int j = y; j < y + h; j++) {
-            oled_draw_pixel(i, j);
-        }
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = (x + w > SCREEN_WIDTH ? SCREEN_WIDTH : x + w) - 1;
+    int y1 = (y + h > SCREEN_HEIGHT ? SCREEN_HEIGHT : y + h) - 1;
+    if (x0 > x1 || y0 > y1) return;
+    
+    // Una máscara por página en lugar de un pixel por bit
+    for (int page = y0 >> 3; page <= (y1 >> 3); page++) {
+        uint8_t mask = 0xFF;
+        if (page == (y0 >> 3)) mask &= 0xFF << (y0 & 7);
+        if (page == (y1 >> 3)) mask &= 0xFF >> (7 - (y1 & 7));
+        
+        uint8_t *row = &oled_buffer[page * SCREEN_WIDTH];
+        for (int i = x0; i <= x1; i++) row[i] |= mask;
+        oled_mark_dirty(&s_back_dirty, page, x0, x1);
     }
 }
 
-// FUNCIÓN CORREGIDA - Versión simplificada y funcional
 void oled_draw_text(int x, int y, const char *text) {
-    // Usar el font directamente desde la variable global
-    const uint8_t (*font)[5] = font_5x7;
-    
     for (int i = 0; text[i] != '\0'; i++) {
         char c = text[i];
         if (c < 32 || c > 126) continue;
@@ -179,20 +485,8 @@ void oled_draw_text(int x, int y, const char *text) {
         int char_x = x + i * 6; // 5px ancho + 1px espacio
         if (char_x >= SCREEN_WIDTH) break;
         
-        // Obtener los datos del carácter
-        const uint8_t *char_data = font[c - 32];
-        
-        // Dibujar cada columna del carácter
-        for (int col = 0; col < 5; col++) {
-            uint8_t col_data = char_data[col];
-            
-            // Dibujar cada fila (bit) del carácter
-            for (int row = 0; row < 7; row++) {
-                if (col_data & (1 << row)) {
-                    oled_draw_pixel(char_x + col, y + row);
-                }
-            }
-        }
+        // Las columnas del font ya son bytes verticales (bit 0 = fila superior)
+        oled_blit_columns(char_x, y, font_5x7[c - 32], 5);
     }
 }
 
@@ -0,0 +1,97 @@
+#include "power.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "POWER";
+
+static bool s_light_sleep = false;
+
+// Acumulados por el callback de salida del light sleep, que se ejecuta en
+// la tarea idle con las interrupciones desactivadas
+static volatile uint32_t s_sleeps = 0;
+static volatile uint64_t s_sleep_us = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Ventana de medida en curso y resultado de la última cerrada
+static int64_t s_window_start_us = 0;
+static uint32_t s_window_sleeps = 0;
+static uint64_t s_window_sleep_us = 0;
+static uint32_t s_wakeups_per_min = 0;
+static uint32_t s_sleep_permille = 0;
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static esp_err_t IRAM_ATTR power_sleep_exit_cb(int64_t slept_us, void *arg) {
+    s_sleeps++;
+    s_sleep_us += slept_us;
+    return ESP_OK;
+}
+#endif
+
+void power_init(void) {
+    s_window_start_us = esp_timer_get_time();
+    
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t config = {
+        .max_freq_mhz = POWER_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_CPU_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = POWER_LIGHT_SLEEP,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure: %s", esp_err_to_name(err));
+        return;
+    }
+    s_light_sleep = config.light_sleep_enable;
+    
+    // El botón (nivel en el GPIO, ver hardware.c) también despierta al chip
+    esp_sleep_enable_gpio_wakeup();
+    
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = power_sleep_exit_cb,
+    };
+    esp_pm_light_sleep_register_cbs(&cbs);
+#endif
+    ESP_LOGI(TAG, "CPU %d-%d MHz, light sleep %s", POWER_MIN_CPU_FREQ_MHZ, POWER_MAX_CPU_FREQ_MHZ,
+             s_light_sleep ? "automático" : "desactivado");
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE desactivado: sin modo de bajo consumo");
+#endif
+}
+
+void power_update(void) {
+    portENTER_CRITICAL(&s_lock);
+    uint32_t sleeps = s_sleeps;
+    uint64_t sleep_us = s_sleep_us;
+    portEXIT_CRITICAL(&s_lock);
+    
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - s_window_start_us;
+    if (elapsed <= 0) return;
+    
+    s_wakeups_per_min = (uint32_t)((uint64_t)(sleeps - s_window_sleeps) * 60000000ULL / (uint64_t)elapsed);
+    s_sleep_permille = (uint32_t)((sleep_us - s_window_sleep_us) * 1000 / (uint64_t)elapsed);
+    s_window_start_us = now;
+    s_window_sleeps = sleeps;
+    s_window_sleep_us = sleep_us;
+    
+    ESP_LOGI(TAG, "Despertares/min: %lu, dormido: %lu.%lu%%", s_wakeups_per_min,
+             s_sleep_permille / 10, s_sleep_permille % 10);
+}
+
+void power_get_stats(power_stats_t *out) {
+    portENTER_CRITICAL(&s_lock);
+    out->sleeps = s_sleeps;
+    out->sleep_us = s_sleep_us;
+    portEXIT_CRITICAL(&s_lock);
+    out->light_sleep = s_light_sleep;
+    out->wakeups_per_min = s_wakeups_per_min;
+    out->sleep_permille = s_sleep_permille;
+}
\ No newline at end of file
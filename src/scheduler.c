@@ -0,0 +1,358 @@
+#include "scheduler.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "SCHED";
+
+// Rueda jerárquica: 4 niveles de 64 ranuras. La ranura del nivel L abarca
+// 64^L ticks, así que con ticks de 1 ms el nivel 0 cubre 64 ms, el 1 ~4 s,
+// el 2 ~4.4 min y el 3 ~4.7 h. Cada trabajo está en el nivel más bajo cuyo
+// intervalo comparte con el instante actual de la rueda; al entrar en una
+// ranura de nivel superior sus trabajos bajan de nivel (cascada).
+#define WHEEL_BITS      6
+#define WHEEL_SLOTS     (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS    4
+
+_Static_assert((int64_t)SCHEDULER_MAX_DELAY_MS * 1000 / SCHEDULER_TICK_US <
+               ((int64_t)WHEEL_SLOTS - 1) << (WHEEL_BITS * (WHEEL_LEVELS - 1)),
+               "SCHEDULER_MAX_DELAY_MS no cabe en la rueda");
+
+typedef struct scheduler_job {
+    const char *name;
+    scheduler_fn_t fn;
+    void *ctx;
+    int64_t period_us;              // 0 = trabajo puntual
+    int64_t deadline_us;            // 0 = sin plazo
+    int64_t grid_us;                // Siguiente instante de la rejilla periódica
+    int64_t due_us;                 // Instante de la ejecución armada
+    int64_t fired_us;               // due_us de la ejecución en curso
+    int64_t expire_tick;
+    struct scheduler_job *next;
+    struct scheduler_job **pprev;   // NULL si no está en la rueda
+    uint8_t level;
+    uint8_t slot;
+    uint32_t runs;
+    uint32_t deadline_misses;
+    uint32_t skipped;
+    uint32_t max_late_us;
+    uint32_t max_run_us;
+    uint64_t late_sum_us;
+} scheduler_job_t;
+
+static scheduler_job_t s_jobs[SCHEDULER_MAX_JOBS];
+static int s_job_count = 0;
+
+static scheduler_job_t *s_wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+static uint64_t s_wheel_used[WHEEL_LEVELS];     // Un bit por ranura no vacía
+static int64_t s_now_tick = 0;                  // Instante hasta el que se procesó la rueda
+static int64_t s_epoch_us = 0;                  // Origen de la rejilla de periodos
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = NULL;
+static TaskHandle_t s_task = NULL;
+static uint32_t s_wakeups = 0;
+
+static int64_t scheduler_us_to_tick(int64_t us) {
+    return (us + SCHEDULER_TICK_US - 1) / SCHEDULER_TICK_US;
+}
+
+static void wheel_link(scheduler_job_t *job, int level, int slot) {
+    scheduler_job_t **head = &s_wheel[level][slot];
+    job->next = *head;
+    if (*head != NULL) (*head)->pprev = &job->next;
+    *head = job;
+    job->pprev = head;
+    job->level = level;
+    job->slot = slot;
+    s_wheel_used[level] |= 1ULL << slot;
+}
+
+static void wheel_unlink(scheduler_job_t *job) {
+    if (job->pprev == NULL) return;
+    *job->pprev = job->next;
+    if (job->next != NULL) job->next->pprev = job->pprev;
+    if (s_wheel[job->level][job->slot] == NULL) {
+        s_wheel_used[job->level] &= ~(1ULL << job->slot);
+    }
+    job->next = NULL;
+    job->pprev = NULL;
+}
+
+// Coloca el trabajo según su vencimiento respecto a s_now_tick. Uno que
+// vence justo ahora va a la ranura actual del nivel 0, que se recoge a
+// continuación en wheel_advance().
+static void wheel_insert(scheduler_job_t *job) {
+    uint64_t diff = (uint64_t)(job->expire_tick ^ s_now_tick);
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && (diff >> (WHEEL_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    wheel_link(job, level, (int)(job->expire_tick >> (WHEEL_BITS * level)) & WHEEL_MASK);
+}
+
+// Primer vencimiento pendiente. Los niveles bajos siempre vencen antes que
+// los altos; dentro de un nivel se busca la primera ranura ocupada a partir
+// de la actual (circularmente: el último nivel puede dar la vuelta).
+static bool wheel_next_tick(int64_t *out) {
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        uint64_t used = s_wheel_used[level];
+        if (used == 0) continue;
+
+        int from = (int)((s_now_tick >> (WHEEL_BITS * level)) + 1) & WHEEL_MASK;
+        uint64_t rotated = from ? (used >> from) | (used << (WHEEL_SLOTS - from)) : used;
+        int slot = (from + __builtin_ctzll(rotated)) & WHEEL_MASK;
+
+        int64_t first = INT64_MAX;
+        for (scheduler_job_t *job = s_wheel[level][slot]; job != NULL; job = job->next) {
+            if (job->expire_tick < first) first = job->expire_tick;
+        }
+        *out = first;
+        return true;
+    }
+    return false;
+}
+
+// Avanza la rueda hasta tick, que no puede ser posterior al primer
+// vencimiento: así las ranuras que se saltan están vacías y solo hay que
+// bajar de nivel las que contienen el nuevo instante. Los trabajos que
+// vencen en tick se añaden a ready.
+static void wheel_advance(int64_t tick, scheduler_job_t **ready, int *ready_count) {
+    int64_t old = s_now_tick;
+    s_now_tick = tick;
+
+    for (int level = WHEEL_LEVELS - 1; level >= 1; level--) {
+        int shift = WHEEL_BITS * level;
+        if ((tick >> shift) == (old >> shift)) continue;
+
+        int slot = (int)(tick >> shift) & WHEEL_MASK;
+        scheduler_job_t *job = s_wheel[level][slot];
+        s_wheel[level][slot] = NULL;
+        s_wheel_used[level] &= ~(1ULL << slot);
+        while (job != NULL) {
+            scheduler_job_t *next = job->next;
+            job->next = NULL;
+            job->pprev = NULL;
+            wheel_insert(job);
+            job = next;
+        }
+    }
+
+    int slot = (int)tick & WHEEL_MASK;
+    scheduler_job_t *job = s_wheel[0][slot];
+    s_wheel[0][slot] = NULL;
+    s_wheel_used[0] &= ~(1ULL << slot);
+    while (job != NULL) {
+        scheduler_job_t *next = job->next;
+        job->next = NULL;
+        job->pprev = NULL;
+        job->fired_us = job->due_us;
+        ready[(*ready_count)++] = job;
+        job = next;
+    }
+}
+
+// Arma la siguiente ejecución, salvo que ya haya una anterior. Con s_lock.
+static void scheduler_arm_locked(scheduler_job_t *job, int64_t due_us) {
+    if (job->pprev != NULL) {
+        if (job->due_us <= due_us) return;
+        wheel_unlink(job);
+    }
+    job->due_us = due_us;
+    job->expire_tick = scheduler_us_to_tick(due_us);
+    if (job->expire_tick <= s_now_tick) {
+        job->expire_tick = s_now_tick + 1;
+    }
+    wheel_insert(job);
+}
+
+static void scheduler_wake(void) {
+    if (s_task != NULL && s_task != xTaskGetCurrentTaskHandle()) {
+        xTaskNotifyGive(s_task);
+    }
+}
+
+static void scheduler_timer_cb(void *arg) {
+    xTaskNotifyGive(s_task);
+}
+
+void scheduler_init(void) {
+    // Rejilla alineada con los ticks: los periódicos no acumulan redondeo
+    s_now_tick = scheduler_us_to_tick(esp_timer_get_time());
+    s_epoch_us = s_now_tick * SCHEDULER_TICK_US;
+
+    const esp_timer_create_args_t args = {
+        .callback = scheduler_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "scheduler",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &s_timer));
+}
+
+static int scheduler_add(const char *name, scheduler_fn_t fn, void *ctx,
+                         uint32_t period_ms, uint32_t deadline_ms) {
+    if (fn == NULL || period_ms > SCHEDULER_MAX_DELAY_MS) return -1;
+
+    portENTER_CRITICAL(&s_lock);
+    if (s_job_count >= SCHEDULER_MAX_JOBS) {
+        portEXIT_CRITICAL(&s_lock);
+        ESP_LOGE(TAG, "Sin hueco para el trabajo %s", name);
+        return -1;
+    }
+    int id = s_job_count++;
+    scheduler_job_t *job = &s_jobs[id];
+    memset(job, 0, sizeof(*job));
+    job->name = name;
+    job->fn = fn;
+    job->ctx = ctx;
+    job->period_us = (int64_t)period_ms * 1000;
+    job->deadline_us = (int64_t)deadline_ms * 1000;
+    portEXIT_CRITICAL(&s_lock);
+    return id;
+}
+
+int scheduler_add_periodic(const char *name, scheduler_fn_t fn, void *ctx,
+                           uint32_t period_ms, uint32_t phase_ms, uint32_t deadline_ms) {
+    if (period_ms == 0) return -1;
+    int id = scheduler_add(name, fn, ctx, period_ms, deadline_ms);
+    if (id < 0) return -1;
+
+    scheduler_job_t *job = &s_jobs[id];
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    // Se alinea con la rejilla común aunque se registre tarde
+    job->grid_us = s_epoch_us + (int64_t)(phase_ms % period_ms) * 1000;
+    if (job->grid_us < now) {
+        job->grid_us += ((now - job->grid_us) / job->period_us + 1) * job->period_us;
+    }
+    scheduler_arm_locked(job, job->grid_us);
+    portEXIT_CRITICAL(&s_lock);
+
+    scheduler_wake();
+    return id;
+}
+
+int scheduler_add_oneshot(const char *name, scheduler_fn_t fn, void *ctx, uint32_t deadline_ms) {
+    return scheduler_add(name, fn, ctx, 0, deadline_ms);
+}
+
+void scheduler_run_in(int job, uint32_t delay_ms) {
+    if (job < 0 || job >= s_job_count) return;
+    if (delay_ms > SCHEDULER_MAX_DELAY_MS) delay_ms = SCHEDULER_MAX_DELAY_MS;
+
+    int64_t due = esp_timer_get_time() + (int64_t)delay_ms * 1000;
+    portENTER_CRITICAL(&s_lock);
+    scheduler_arm_locked(&s_jobs[job], due);
+    portEXIT_CRITICAL(&s_lock);
+
+    scheduler_wake();
+}
+
+static void scheduler_execute(scheduler_job_t *job) {
+    int64_t start = esp_timer_get_time();
+    job->fn(job->ctx);
+    int64_t end = esp_timer_get_time();
+
+    int64_t late = start - job->fired_us;
+    if (late < 0) late = 0;
+
+    portENTER_CRITICAL(&s_lock);
+    job->runs++;
+    job->late_sum_us += (uint64_t)late;
+    if (late > job->max_late_us) job->max_late_us = (uint32_t)late;
+    if (end - start > job->max_run_us) job->max_run_us = (uint32_t)(end - start);
+    bool missed = job->deadline_us > 0 && late > job->deadline_us;
+    if (missed) job->deadline_misses++;
+
+    if (job->period_us > 0) {
+        // Un adelanto por scheduler_run_in() no mueve la rejilla
+        if (job->fired_us >= job->grid_us) {
+            job->grid_us += job->period_us;
+            while (job->grid_us <= end) {
+                job->grid_us += job->period_us;
+                job->skipped++;
+            }
+        }
+        scheduler_arm_locked(job, job->grid_us);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (missed) {
+        ESP_LOGD(TAG, "%s empezó %lld us tarde", job->name, late);
+    }
+}
+
+void scheduler_run(void) {
+    s_task = xTaskGetCurrentTaskHandle();
+    ESP_LOGI(TAG, "Planificador en marcha con %d trabajos", s_job_count);
+
+    while (1) {
+        scheduler_job_t *ready[SCHEDULER_MAX_JOBS];
+        int ready_count = 0;
+        int64_t next_tick;
+        bool pending;
+
+        // Todo lo vencido hasta ahora, en orden; después la rueda se pone en
+        // hora (nada vence antes de ese instante)
+        portENTER_CRITICAL(&s_lock);
+        int64_t now_tick = esp_timer_get_time() / SCHEDULER_TICK_US;
+        while ((pending = wheel_next_tick(&next_tick)) && next_tick <= now_tick) {
+            wheel_advance(next_tick, ready, &ready_count);
+        }
+        if (now_tick > s_now_tick) {
+            wheel_advance(now_tick, ready, &ready_count);
+        }
+        portEXIT_CRITICAL(&s_lock);
+
+        for (int i = 0; i < ready_count; i++) {
+            scheduler_execute(ready[i]);
+        }
+        if (ready_count > 0) {
+            continue;   // Pudo pasar el tiempo o armarse algo mientras tanto
+        }
+
+        // Dormir hasta el siguiente vencimiento (o hasta que se arme otro)
+        if (pending) {
+            int64_t delay = next_tick * SCHEDULER_TICK_US - esp_timer_get_time();
+            if (delay <= 0) continue;
+            esp_timer_stop(s_timer);
+            esp_timer_start_once(s_timer, (uint64_t)delay);
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        s_wakeups++;
+    }
+}
+
+bool scheduler_get_stats(int job, scheduler_job_stats_t *out) {
+    if (job < 0 || job >= s_job_count) return false;
+
+    const scheduler_job_t *j = &s_jobs[job];
+    portENTER_CRITICAL(&s_lock);
+    out->name = j->name;
+    out->runs = j->runs;
+    out->deadline_misses = j->deadline_misses;
+    out->skipped = j->skipped;
+    out->max_late_us = j->max_late_us;
+    out->avg_late_us = j->runs ? (uint32_t)(j->late_sum_us / j->runs) : 0;
+    out->max_run_us = j->max_run_us;
+    portEXIT_CRITICAL(&s_lock);
+    return true;
+}
+
+int scheduler_job_count(void) {
+    return s_job_count;
+}
+
+void scheduler_log_stats(void) {
+    ESP_LOGI(TAG, "Despertares: %lu", s_wakeups);
+    for (int i = 0; i < s_job_count; i++) {
+        scheduler_job_stats_t stats;
+        scheduler_get_stats(i, &stats);
+        ESP_LOGI(TAG, "%-10s runs=%lu retraso medio=%lu us máx=%lu us ejec. máx=%lu us plazos=%lu saltos=%lu",
+                 stats.name, stats.runs, stats.avg_late_us, stats.max_late_us,
+                 stats.max_run_us, stats.deadline_misses, stats.skipped);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "sensor_history.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "HISTORY";
+
+// Periodo (s) de cada nivel; el nivel crudo sigue al muestreo del DHT11
+static const uint32_t TIER_PERIOD_S[SENSOR_TIER_COUNT] = { 5, 60, 15 * 60 };
+static const char *TIER_NAME[SENSOR_TIER_COUNT] = { "raw", "1m", "15m" };
+static const uint16_t TIER_LEN[SENSOR_TIER_COUNT] = {
+    SENSOR_HISTORY_RAW_LEN, SENSOR_HISTORY_1M_LEN, SENSOR_HISTORY_15M_LEN
+};
+
+// Todo el almacén en un bloque estático de tamaño fijo
+static struct {
+    sensor_sample_t raw[SENSOR_HISTORY_RAW_LEN];
+    sensor_rollup_t min1[SENSOR_HISTORY_1M_LEN];
+    sensor_rollup_t min15[SENSOR_HISTORY_15M_LEN];
+    sensor_rollup_acc_t acc[SENSOR_TIER_COUNT - 1];     // 1m y 15m
+    sensor_ring_t ring[SENSOR_TIER_COUNT];
+} s_store;
+
+_Static_assert(sizeof(s_store) == SENSOR_HISTORY_MEMORY_BYTES,
+               "SENSOR_HISTORY_MEMORY_BYTES no coincide con el almacén real");
+
+static SemaphoreHandle_t s_mutex = NULL;
+
+static sensor_rollup_t *rollup_ring(sensor_tier_t tier) {
+    return tier == SENSOR_TIER_1MIN ? s_store.min1 : s_store.min15;
+}
+
+// Posición física del elemento lógico 'index' (0 = más antiguo)
+static uint16_t ring_slot(sensor_tier_t tier, uint16_t index) {
+    const sensor_ring_t *ring = &s_store.ring[tier];
+    uint32_t slot = ring->head + TIER_LEN[tier] - ring->count + index;
+    return slot % TIER_LEN[tier];
+}
+
+// Reserva la siguiente posición del buffer circular, pisando la más antigua
+static uint16_t ring_push(sensor_tier_t tier) {
+    sensor_ring_t *ring = &s_store.ring[tier];
+    uint16_t slot = ring->head;
+    ring->head = (ring->head + 1) % TIER_LEN[tier];
+    if (ring->count < TIER_LEN[tier]) ring->count++;
+    return slot;
+}
+
+static uint32_t point_time(sensor_tier_t tier, uint16_t slot) {
+    return tier == SENSOR_TIER_RAW ? s_store.raw[slot].time_s : rollup_ring(tier)[slot].start_s;
+}
+
+static void acc_close(sensor_tier_t tier) {
+    sensor_rollup_acc_t *acc = &s_store.acc[tier - 1];
+    if (acc->count == 0) return;
+    
+    sensor_rollup_t *out = &rollup_ring(tier)[ring_push(tier)];
+    out->start_s = acc->start_s;
+    out->temp_min_x10 = acc->temp_min_x10;
+    out->temp_max_x10 = acc->temp_max_x10;
+    out->temp_avg_x10 = acc->temp_sum / acc->count;
+    out->hum_min_x10 = acc->hum_min_x10;
+    out->hum_max_x10 = acc->hum_max_x10;
+    out->hum_avg_x10 = acc->hum_sum / acc->count;
+    acc->count = 0;
+}
+
+// Actualiza el resumen abierto del nivel; al cruzar el límite del intervalo
+// se cierra el anterior. Coste constante por muestra.
+static void acc_add(sensor_tier_t tier, uint32_t time_s, int16_t temp, uint16_t hum) {
+    sensor_rollup_acc_t *acc = &s_store.acc[tier - 1];
+    uint32_t start = time_s - time_s % TIER_PERIOD_S[tier];
+    
+    if (acc->count > 0 && acc->start_s != start) {
+        acc_close(tier);
+    }
+    if (acc->count == 0) {
+        acc->start_s = start;
+        acc->temp_sum = 0;
+        acc->hum_sum = 0;
+        acc->temp_min_x10 = acc->temp_max_x10 = temp;
+        acc->hum_min_x10 = acc->hum_max_x10 = hum;
+    }
+    
+    acc->temp_sum += temp;
+    acc->hum_sum += hum;
+    if (temp < acc->temp_min_x10) acc->temp_min_x10 = temp;
+    if (temp > acc->temp_max_x10) acc->temp_max_x10 = temp;
+    if (hum < acc->hum_min_x10) acc->hum_min_x10 = hum;
+    if (hum > acc->hum_max_x10) acc->hum_max_x10 = hum;
+    acc->count++;
+}
+
+void sensor_history_init(void) {
+    if (s_mutex != NULL) return;
+    s_mutex = xSemaphoreCreateMutex();
+    ESP_LOGI(TAG, "Histórico del sensor: %u bytes (%u crudas, %u x 1m, %u x 15m)",
+             (unsigned)SENSOR_HISTORY_MEMORY_BYTES, SENSOR_HISTORY_RAW_LEN,
+             SENSOR_HISTORY_1M_LEN, SENSOR_HISTORY_15M_LEN);
+}
+
+void sensor_history_add(uint32_t time_s, int16_t temperature_x10, uint16_t humidity_x10) {
+    if (s_mutex == NULL) return;
+    
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    sensor_sample_t *sample = &s_store.raw[ring_push(SENSOR_TIER_RAW)];
+    sample->time_s = time_s;
+    sample->temperature_x10 = temperature_x10;
+    sample->humidity_x10 = humidity_x10;
+    
+    acc_add(SENSOR_TIER_1MIN, time_s, temperature_x10, humidity_x10);
+    acc_add(SENSOR_TIER_15MIN, time_s, temperature_x10, humidity_x10);
+    xSemaphoreGive(s_mutex);
+}
+
+// Primer índice lógico con tiempo >= from_s (búsqueda binaria: los tiempos
+// de cada buffer circular son crecientes)
+static uint16_t lower_bound(sensor_tier_t tier, uint32_t from_s) {
+    uint16_t lo = 0;
+    uint16_t hi = s_store.ring[tier].count;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if (point_time(tier, ring_slot(tier, mid)) < from_s) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t sensor_history_query(sensor_tier_t tier, uint32_t from_s, uint32_t to_s,
+                            sensor_rollup_t *out, size_t max_points) {
+    if (s_mutex == NULL || tier >= SENSOR_TIER_COUNT || from_s > to_s) return 0;
+    
+    size_t n = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint16_t count = s_store.ring[tier].count;
+    for (uint16_t i = lower_bound(tier, from_s); i < count && n < max_points; i++) {
+        uint16_t slot = ring_slot(tier, i);
+        if (point_time(tier, slot) > to_s) break;
+        
+        if (tier == SENSOR_TIER_RAW) {
+            const sensor_sample_t *sample = &s_store.raw[slot];
+            out[n].start_s = sample->time_s;
+            out[n].temp_min_x10 = out[n].temp_max_x10 = out[n].temp_avg_x10 = sample->temperature_x10;
+            out[n].hum_min_x10 = out[n].hum_max_x10 = out[n].hum_avg_x10 = sample->humidity_x10;
+        } else {
+            out[n] = rollup_ring(tier)[slot];
+        }
+        n++;
+    }
+    xSemaphoreGive(s_mutex);
+    return n;
+}
+
+uint32_t sensor_history_tier_period(sensor_tier_t tier) {
+    return tier < SENSOR_TIER_COUNT ? TIER_PERIOD_S[tier] : 0;
+}
+
+const char* sensor_history_tier_name(sensor_tier_t tier) {
+    return tier < SENSOR_TIER_COUNT ? TIER_NAME[tier] : "?";
+}
\ No newline at end of file
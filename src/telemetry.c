@@ -0,0 +1,198 @@
+#include "telemetry.h"
+#include "hardware.h"
+#include "mqtt_app.h"
+#include "cbor_writer.h"
+#include "json_writer.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const char *TAG = "TELEMETRY";
+
+typedef enum {
+    TELEMETRY_FIELD_LED = 0,
+    TELEMETRY_FIELD_BUTTON,
+    TELEMETRY_FIELD_PRESSES,
+    TELEMETRY_FIELD_TEMPERATURE,
+    TELEMETRY_FIELD_HUMIDITY,
+    TELEMETRY_FIELD_SENSOR_VALID,
+    TELEMETRY_FIELD_COUNT
+} telemetry_field_id_t;
+
+// Los valores se guardan como enteros (décimas para el sensor) para que la
+// comparación con la banda muerta sea exacta
+typedef struct {
+    const char *name;
+    telemetry_key_t key;
+    int32_t deadband;       // 0 = cualquier cambio cuenta
+    uint8_t decimals;       // 1 = valor en décimas
+    bool needs_valid;       // Ignorar mientras el sensor no tenga lectura válida
+} telemetry_field_t;
+
+// Las bandas muertas del sensor se pueden cambiar con telemetry_set_config()
+static telemetry_field_t s_fields[TELEMETRY_FIELD_COUNT] = {
+    [TELEMETRY_FIELD_LED]          = { "led",          TELEMETRY_KEY_LED,          0, 0, false },
+    [TELEMETRY_FIELD_BUTTON]       = { "button",       TELEMETRY_KEY_BUTTON,       0, 0, false },
+    [TELEMETRY_FIELD_PRESSES]      = { "presses",      TELEMETRY_KEY_PRESSES,      0, 0, false },
+    [TELEMETRY_FIELD_TEMPERATURE]  = { "temperature",  TELEMETRY_KEY_TEMPERATURE,  TELEMETRY_TEMP_DEADBAND_X10, 1, true },
+    [TELEMETRY_FIELD_HUMIDITY]     = { "humidity",     TELEMETRY_KEY_HUMIDITY,     TELEMETRY_HUMIDITY_DEADBAND_X10, 1, true },
+    [TELEMETRY_FIELD_SENSOR_VALID] = { "sensor_valid", TELEMETRY_KEY_SENSOR_VALID, 0, 0, false },
+};
+
+static int32_t s_published[TELEMETRY_FIELD_COUNT];
+static bool s_have_published = false;
+static uint32_t s_last_publish_ms = 0;
+static uint32_t s_sent_count = 0;
+static uint32_t s_heartbeat_ms = TELEMETRY_HEARTBEAT_MS;
+
+static uint32_t telemetry_read(int32_t *values)
+{
+    sensor_snapshot_t sensor;
+    hardware_get_sensor_snapshot(&sensor);
+    
+    values[TELEMETRY_FIELD_LED] = led_get_state();
+    values[TELEMETRY_FIELD_BUTTON] = button_read();
+    values[TELEMETRY_FIELD_PRESSES] = button_get_press_count();
+    values[TELEMETRY_FIELD_TEMPERATURE] = sensor.temperature_x10;
+    values[TELEMETRY_FIELD_HUMIDITY] = sensor.humidity_x10;
+    values[TELEMETRY_FIELD_SENSOR_VALID] = sensor.valid;
+    return sensor.sample_seq;
+}
+
+// Devuelve el primer campo que supera su banda muerta, o -1
+static int telemetry_find_change(const int32_t *values)
+{
+    bool valid = values[TELEMETRY_FIELD_SENSOR_VALID] != 0;
+    for (int i = 0; i < TELEMETRY_FIELD_COUNT; i++) {
+        if (s_fields[i].needs_valid && !valid) {
+            continue;
+        }
+        int32_t diff = labs(values[i] - s_published[i]);
+        if (s_fields[i].deadband == 0 ? diff != 0 : diff >= s_fields[i].deadband) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int telemetry_format_json(char *buf, size_t size, const int32_t *values,
+                                 uint32_t seq, int changed)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_obj_begin(&w);
+    json_key(&w, "ts");
+    json_put_int64(&w, (int64_t)time(NULL));
+    for (int i = 0; i < TELEMETRY_FIELD_COUNT; i++) {
+        json_kv_fixed(&w, s_fields[i].name, values[i], s_fields[i].decimals);
+    }
+    json_kv_uint(&w, "seq", seq);
+    json_kv_str(&w, "reason", changed >= 0 ? s_fields[changed].name : "heartbeat");
+    json_obj_end(&w);
+    size_t len = json_writer_finish(&w);
+    return len > 0 ? (int)len : -1;
+}
+
+// Map con claves enteras y valores en punto fijo: ~30 bytes frente a ~150
+// del JSON, y sin formateo de texto
+static int telemetry_format_cbor(uint8_t *buf, size_t size, const int32_t *values,
+                                 uint32_t seq, int changed)
+{
+    cbor_writer_t w;
+    cbor_writer_init(&w, buf, size);
+    cbor_put_map(&w, TELEMETRY_FIELD_COUNT + 3);
+    cbor_put_uint(&w, TELEMETRY_KEY_TS);
+    cbor_put_uint(&w, (uint32_t)time(NULL));
+    for (int i = 0; i < TELEMETRY_FIELD_COUNT; i++) {
+        cbor_put_uint(&w, s_fields[i].key);
+        if (i == TELEMETRY_FIELD_SENSOR_VALID) {
+            cbor_put_bool(&w, values[i] != 0);
+        } else {
+            cbor_put_int(&w, values[i]);
+        }
+    }
+    cbor_put_uint(&w, TELEMETRY_KEY_SEQ);
+    cbor_put_uint(&w, seq);
+    cbor_put_uint(&w, TELEMETRY_KEY_REASON);
+    cbor_put_int(&w, changed >= 0 ? (int32_t)s_fields[changed].key : TELEMETRY_REASON_HEARTBEAT);
+    size_t len = cbor_writer_finish(&w);
+    return len > 0 ? (int)len : -1;
+}
+
+void telemetry_poll(void)
+{
+    int32_t values[TELEMETRY_FIELD_COUNT];
+    uint32_t seq = telemetry_read(values);
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    
+    bool urgent;
+    int changed = s_have_published ? telemetry_find_change(values) : -1;
+    if (changed >= 0) {
+        // Los eventos reales salen en el acto, arrastrando el lote pendiente
+        urgent = true;
+    } else if (!s_have_published || now - s_last_publish_ms >= s_heartbeat_ms) {
+        // El latido puede esperar en el lote
+        urgent = false;
+    } else {
+        return;
+    }
+    
+    uint8_t sample[TELEMETRY_SAMPLE_MAX];
+    int len;
+    if (mqtt_app_get_format(MQTT_BATCH_TELEMETRY) == MQTT_FORMAT_CBOR) {
+        len = telemetry_format_cbor(sample, sizeof(sample), values, seq, changed);
+    } else {
+        len = telemetry_format_json((char *)sample, sizeof(sample), values, seq, changed);
+    }
+    if (len < 0) {
+        ESP_LOGW(TAG, "Muestra demasiado grande");
+        return;
+    }
+    
+    ESP_LOGD(TAG, "Muestra (%s, %d bytes)", changed >= 0 ? s_fields[changed].name : "heartbeat", len);
+    mqtt_app_publish_sample(MQTT_BATCH_TELEMETRY, sample, len, urgent);
+    
+    // La banda muerta se mide contra lo último publicado, así una deriva lenta
+    // también acaba generando una muestra. Los valores del sensor se
+    // conservan mientras no hay lectura válida.
+    for (int i = 0; i < TELEMETRY_FIELD_COUNT; i++) {
+        if (!s_fields[i].needs_valid || values[TELEMETRY_FIELD_SENSOR_VALID]) {
+            s_published[i] = values[i];
+        }
+    }
+    s_have_published = true;
+    s_last_publish_ms = now;
+    s_sent_count++;
+}
+
+uint32_t telemetry_get_sent_count(void)
+{
+    return s_sent_count;
+}
+
+void telemetry_get_config(telemetry_config_t *out)
+{
+    out->heartbeat_ms = s_heartbeat_ms;
+    out->temp_deadband_x10 = s_fields[TELEMETRY_FIELD_TEMPERATURE].deadband;
+    out->humidity_deadband_x10 = s_fields[TELEMETRY_FIELD_HUMIDITY].deadband;
+}
+
+esp_err_t telemetry_set_config(const telemetry_config_t *config)
+{
+    if (config->heartbeat_ms < TELEMETRY_HEARTBEAT_MIN_MS ||
+        config->heartbeat_ms > TELEMETRY_HEARTBEAT_MAX_MS ||
+        config->temp_deadband_x10 < 1 || config->temp_deadband_x10 > TELEMETRY_DEADBAND_MAX_X10 ||
+        config->humidity_deadband_x10 < 1 || config->humidity_deadband_x10 > TELEMETRY_DEADBAND_MAX_X10) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Escrituras de una palabra: telemetry_poll() ve cada valor viejo o nuevo
+    s_heartbeat_ms = config->heartbeat_ms;
+    s_fields[TELEMETRY_FIELD_TEMPERATURE].deadband = config->temp_deadband_x10;
+    s_fields[TELEMETRY_FIELD_HUMIDITY].deadband = config->humidity_deadband_x10;
+    ESP_LOGI(TAG, "Configuración: latido %lu ms, bandas %ld/%ld décimas",
+             config->heartbeat_ms, config->temp_deadband_x10, config->humidity_deadband_x10);
+    return ESP_OK;
+}
\ No newline at end of file
@@ -0,0 +1,373 @@
+#include "telemetry_queue.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG = "TLM_QUEUE";
+
+#define TQ_SEGMENT_SIZE         4096
+#define TQ_SEGMENT_MAGIC        0x31535154      // "TQS1"
+
+// Estados de un registro. Solo se pasan bits de 1 a 0, así que marcar un
+// registro como consumido es una escritura de un byte sin borrar el sector.
+#define TQ_REC_FREE             0xFF
+#define TQ_REC_VALID            0xFE
+#define TQ_REC_CONSUMED         0x00
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;               // Creciente en orden de escritura
+    uint32_t erase_count;
+    uint32_t reserved;
+} tq_segment_hdr_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t reserved;
+    uint16_t len;
+    uint32_t crc;
+} tq_record_hdr_t;
+
+#define TQ_SEGMENT_HDR_SIZE     sizeof(tq_segment_hdr_t)
+#define TQ_RECORD_HDR_SIZE      sizeof(tq_record_hdr_t)
+
+static const esp_partition_t *s_part = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static uint16_t s_segments = 0;
+static uint32_t s_next_seq = 1;
+static uint32_t s_max_erase_count = 0;
+
+// Posición de escritura (siguiente registro libre)
+static uint16_t s_write_seg = 0;
+static uint32_t s_write_off = TQ_SEGMENT_HDR_SIZE;
+
+// Posición del registro pendiente más antiguo
+static uint16_t s_read_seg = 0;
+static uint32_t s_read_off = TQ_SEGMENT_HDR_SIZE;
+
+static uint32_t s_pending = 0;
+static uint32_t s_dropped = 0;
+static uint32_t s_generation = 0;
+
+static inline uint32_t tq_record_size(uint16_t len) {
+    return (TQ_RECORD_HDR_SIZE + len + 3) & ~3u;
+}
+
+static inline uint16_t tq_next_segment(uint16_t seg) {
+    return (seg + 1) % s_segments;
+}
+
+static inline size_t tq_addr(uint16_t seg, uint32_t off) {
+    return (size_t)seg * TQ_SEGMENT_SIZE + off;
+}
+
+static bool tq_read_segment_hdr(uint16_t seg, tq_segment_hdr_t *hdr) {
+    if (esp_partition_read(s_part, tq_addr(seg, 0), hdr, sizeof(*hdr)) != ESP_OK) return false;
+    return hdr->magic == TQ_SEGMENT_MAGIC;
+}
+
+// Borra el segmento y escribe su cabecera con el siguiente número de secuencia
+static esp_err_t tq_format_segment(uint16_t seg) {
+    tq_segment_hdr_t hdr;
+    uint32_t erase_count = tq_read_segment_hdr(seg, &hdr) ? hdr.erase_count + 1 : 1;
+
+    esp_err_t ret = esp_partition_erase_range(s_part, tq_addr(seg, 0), TQ_SEGMENT_SIZE);
+    if (ret != ESP_OK) return ret;
+
+    hdr.magic = TQ_SEGMENT_MAGIC;
+    hdr.seq = s_next_seq++;
+    hdr.erase_count = erase_count;
+    hdr.reserved = 0xFFFFFFFF;
+    if (erase_count > s_max_erase_count) s_max_erase_count = erase_count;
+    return esp_partition_write(s_part, tq_addr(seg, 0), &hdr, sizeof(hdr));
+}
+
+// Coloca la posición al inicio de los datos del segmento, o al final si el
+// segmento no tiene formato (nunca usado o borrado a medias)
+static void tq_enter_segment(uint16_t seg, uint32_t *off) {
+    tq_segment_hdr_t hdr;
+    *off = tq_read_segment_hdr(seg, &hdr) ? TQ_SEGMENT_HDR_SIZE : TQ_SEGMENT_SIZE;
+}
+
+// Busca el siguiente registro válido a partir de (seg, off), saltando los
+// consumidos, los corruptos y los segmentos sin formato. Devuelve false al
+// alcanzar la posición de escritura.
+static bool tq_seek_valid(uint16_t *seg, uint32_t *off, tq_record_hdr_t *rec) {
+    for (uint32_t hops = 0; hops <= s_segments; ) {
+        if (*seg == s_write_seg && *off >= s_write_off) return false;
+
+        bool end_of_segment = (*off + TQ_RECORD_HDR_SIZE > TQ_SEGMENT_SIZE);
+        if (!end_of_segment) {
+            if (esp_partition_read(s_part, tq_addr(*seg, *off), rec, sizeof(*rec)) != ESP_OK) return false;
+            end_of_segment = (rec->state == TQ_REC_FREE ||
+                              rec->len > TELEMETRY_QUEUE_MAX_RECORD ||
+                              *off + tq_record_size(rec->len) > TQ_SEGMENT_SIZE);
+        }
+
+        if (end_of_segment) {
+            if (*seg == s_write_seg) return false;
+            *seg = tq_next_segment(*seg);
+            tq_enter_segment(*seg, off);
+            hops++;
+            continue;
+        }
+
+        if (rec->state == TQ_REC_VALID) return true;
+        *off += tq_record_size(rec->len);
+    }
+    return false;
+}
+
+// Cuenta los registros pendientes de un segmento (para descartarlo)
+static uint32_t tq_count_valid(uint16_t seg) {
+    uint32_t count = 0;
+    uint32_t off = TQ_SEGMENT_HDR_SIZE;
+    tq_record_hdr_t rec;
+    while (off + TQ_RECORD_HDR_SIZE <= TQ_SEGMENT_SIZE) {
+        if (seg == s_write_seg && off >= s_write_off) break;
+        if (esp_partition_read(s_part, tq_addr(seg, off), &rec, sizeof(rec)) != ESP_OK) break;
+        if (rec.state == TQ_REC_FREE || rec.len > TELEMETRY_QUEUE_MAX_RECORD) break;
+        if (rec.state == TQ_REC_VALID) count++;
+        off += tq_record_size(rec.len);
+    }
+    return count;
+}
+
+static void tq_normalize_read(void) {
+    tq_record_hdr_t rec;
+    if (!tq_seek_valid(&s_read_seg, &s_read_off, &rec)) {
+        s_read_seg = s_write_seg;
+        s_read_off = s_write_off;
+    }
+}
+
+// Pasa al siguiente segmento; si contiene datos pendientes se descartan
+static esp_err_t tq_rotate(void) {
+    uint16_t next = tq_next_segment(s_write_seg);
+
+    if (s_pending > 0 && s_read_seg == next) {
+        tq_segment_hdr_t hdr;
+        uint32_t lost = tq_read_segment_hdr(next, &hdr) ? tq_count_valid(next) : 0;
+        s_pending -= (lost < s_pending) ? lost : s_pending;
+        s_dropped += lost;
+        s_generation++;
+        s_read_seg = tq_next_segment(next);
+        tq_enter_segment(s_read_seg, &s_read_off);
+        ESP_LOGW(TAG, "Cola llena: %lu registros descartados", lost);
+    }
+
+    esp_err_t ret = tq_format_segment(next);
+    if (ret != ESP_OK) return ret;
+
+    s_write_seg = next;
+    s_write_off = TQ_SEGMENT_HDR_SIZE;
+    if (s_pending == 0) {
+        s_read_seg = s_write_seg;
+        s_read_off = s_write_off;
+    } else {
+        tq_normalize_read();
+    }
+    return ESP_OK;
+}
+
+esp_err_t telemetry_queue_init(void) {
+    if (s_part != NULL) return ESP_OK;
+
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, TELEMETRY_QUEUE_SUBTYPE,
+                                      TELEMETRY_QUEUE_PARTITION);
+    if (s_part == NULL) {
+        ESP_LOGE(TAG, "No existe la partición '%s'", TELEMETRY_QUEUE_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_segments = s_part->size / TQ_SEGMENT_SIZE;
+    if (s_segments < 2) {
+        s_part = NULL;
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_mutex = xSemaphoreCreateMutex();
+
+    // El segmento con la secuencia más alta es el de escritura
+    bool found = false;
+    uint32_t max_seq = 0;
+    for (uint16_t seg = 0; seg < s_segments; seg++) {
+        tq_segment_hdr_t hdr;
+        if (!tq_read_segment_hdr(seg, &hdr)) continue;
+        if (hdr.erase_count > s_max_erase_count) s_max_erase_count = hdr.erase_count;
+        if (!found || hdr.seq > max_seq) {
+            found = true;
+            max_seq = hdr.seq;
+            s_write_seg = seg;
+        }
+    }
+
+    if (!found) {
+        s_write_seg = 0;
+        esp_err_t ret = tq_format_segment(0);
+        if (ret != ESP_OK) return ret;
+        s_write_off = TQ_SEGMENT_HDR_SIZE;
+    } else {
+        s_next_seq = max_seq + 1;
+        // Fin de los datos del segmento de escritura
+        s_write_off = TQ_SEGMENT_HDR_SIZE;
+        tq_record_hdr_t rec;
+        while (s_write_off + TQ_RECORD_HDR_SIZE <= TQ_SEGMENT_SIZE) {
+            if (esp_partition_read(s_part, tq_addr(s_write_seg, s_write_off), &rec, sizeof(rec)) != ESP_OK) break;
+            if (rec.state == TQ_REC_FREE) break;
+            if (rec.len > TELEMETRY_QUEUE_MAX_RECORD) {
+                // Escritura interrumpida: el resto del segmento no es fiable
+                s_write_off = TQ_SEGMENT_SIZE;
+                break;
+            }
+            s_write_off += tq_record_size(rec.len);
+        }
+    }
+
+    // Registros pendientes, del segmento más antiguo al de escritura
+    s_pending = 0;
+    s_read_seg = tq_next_segment(s_write_seg);
+    tq_enter_segment(s_read_seg, &s_read_off);
+    tq_normalize_read();
+    tq_segment_hdr_t hdr;
+    for (uint16_t i = 0, seg = s_read_seg; i < s_segments; i++, seg = tq_next_segment(seg)) {
+        if (tq_read_segment_hdr(seg, &hdr)) s_pending += tq_count_valid(seg);
+        if (seg == s_write_seg) break;
+    }
+
+    ESP_LOGI(TAG, "Cola de telemetría: %u segmentos, %lu registros pendientes",
+             s_segments, s_pending);
+    return ESP_OK;
+}
+
+esp_err_t telemetry_queue_push(const void *data, size_t len) {
+    if (s_part == NULL) return ESP_ERR_INVALID_STATE;
+    if (len == 0 || len > TELEMETRY_QUEUE_MAX_RECORD) return ESP_ERR_INVALID_SIZE;
+
+    // Cabecera y carga en una sola escritura (la cabecera va primero)
+    uint8_t buf[TQ_RECORD_HDR_SIZE + TELEMETRY_QUEUE_MAX_RECORD + 3];
+    uint32_t size = tq_record_size(len);
+    tq_record_hdr_t rec = {
+        .state = TQ_REC_VALID,
+        .reserved = 0xFF,
+        .len = len,
+        .crc = esp_crc32_le(0, data, len),
+    };
+    memcpy(buf, &rec, sizeof(rec));
+    memcpy(buf + sizeof(rec), data, len);
+    memset(buf + sizeof(rec) + len, 0xFF, size - sizeof(rec) - len);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    if (s_write_off + size > TQ_SEGMENT_SIZE) {
+        ret = tq_rotate();
+    }
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(s_part, tq_addr(s_write_seg, s_write_off), buf, size);
+        if (ret == ESP_OK) {
+            if (s_pending == 0) {
+                s_read_seg = s_write_seg;
+                s_read_off = s_write_off;
+            }
+            s_write_off += size;
+            s_pending++;
+        } else {
+            // No reutilizar una zona posiblemente a medio escribir
+            s_write_off = TQ_SEGMENT_SIZE;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Error al guardar registro: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void telemetry_queue_cursor_init(telemetry_queue_cursor_t *cursor) {
+    if (s_part == NULL) {
+        memset(cursor, 0, sizeof(*cursor));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    cursor->segment = s_read_seg;
+    cursor->offset = s_read_off;
+    cursor->records = 0;
+    cursor->skipped = 0;
+    cursor->generation = s_generation;
+    xSemaphoreGive(s_mutex);
+}
+
+esp_err_t telemetry_queue_read(telemetry_queue_cursor_t *cursor, void *buf, size_t buf_len, size_t *out_len) {
+    if (s_part == NULL) return ESP_ERR_NOT_FOUND;
+
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (cursor->generation != s_generation) {
+        // Se descartaron datos bajo el cursor: hay que empezar de nuevo
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        tq_record_hdr_t rec;
+        while (tq_seek_valid(&cursor->segment, &cursor->offset, &rec)) {
+            size_t addr = tq_addr(cursor->segment, cursor->offset);
+            cursor->offset += tq_record_size(rec.len);
+            cursor->records++;
+
+            // Los registros que no se devuelven cuentan en 'records' (para que
+            // telemetry_queue_consume() los retire) y también en 'skipped'
+            if (rec.len > buf_len) {
+                cursor->skipped++;
+                ret = ESP_ERR_INVALID_SIZE;
+                break;
+            }
+            if (esp_partition_read(s_part, addr + TQ_RECORD_HDR_SIZE, buf, rec.len) != ESP_OK ||
+                esp_crc32_le(0, buf, rec.len) != rec.crc) {
+                ESP_LOGW(TAG, "Registro corrupto descartado");
+                cursor->skipped++;
+                continue;
+            }
+            *out_len = rec.len;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return ret;
+}
+
+esp_err_t telemetry_queue_consume(const telemetry_queue_cursor_t *cursor) {
+    if (s_part == NULL) return ESP_ERR_INVALID_STATE;
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (cursor->generation != s_generation) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        // El único lector avanza en orden, así que los registros leídos son
+        // exactamente los primeros 'records' registros válidos pendientes
+        const uint8_t consumed = TQ_REC_CONSUMED;
+        tq_record_hdr_t rec;
+        for (uint32_t n = cursor->records; n > 0 && tq_seek_valid(&s_read_seg, &s_read_off, &rec); n--) {
+            esp_partition_write(s_part, tq_addr(s_read_seg, s_read_off), &consumed, 1);
+            s_read_off += tq_record_size(rec.len);
+            if (s_pending > 0) s_pending--;
+        }
+        tq_normalize_read();
+    }
+    xSemaphoreGive(s_mutex);
+    return ret;
+}
+
+uint32_t telemetry_queue_pending(void) {
+    return s_pending;
+}
+
+void telemetry_queue_get_stats(telemetry_queue_stats_t *stats) {
+    if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY);
+    stats->pending = s_pending;
+    stats->dropped = s_dropped;
+    stats->segments = s_segments;
+    stats->max_erase_count = s_max_erase_count;
+    if (s_mutex) xSemaphoreGive(s_mutex);
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "ui.h"
+#include "oled.h"
+#include "wifi_config.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+
+static const char *TAG = "UI";
+
+// Índices de las fuentes de versión (uno por bit de ui_binding_t)
+enum {
+    UI_SRC_LED = 0,
+    UI_SRC_BUTTON,
+    UI_SRC_PRESS_COUNT,
+    UI_SRC_SENSOR,
+    UI_SRC_NETWORK,
+    UI_SRC_COUNT
+};
+
+static const ui_screen_t *s_screen = NULL;
+static uint32_t s_rendered_versions[UI_SRC_COUNT];
+static bool s_force_render = true;
+static uint32_t s_last_render_ms = 0;
+
+static uint32_t ui_now_ms(void) {
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+// Lee la versión actual de cada fuente de la que depende la pantalla
+static void ui_read_versions(uint32_t bindings, uint32_t versions[UI_SRC_COUNT]) {
+    memset(versions, 0, sizeof(uint32_t) * UI_SRC_COUNT);
+    if (bindings & UI_BIND_LED) versions[UI_SRC_LED] = led_get_version();
+    if (bindings & UI_BIND_BUTTON) versions[UI_SRC_BUTTON] = button_get_version();
+    if (bindings & UI_BIND_PRESS_COUNT) versions[UI_SRC_PRESS_COUNT] = button_get_press_count();
+    if (bindings & UI_BIND_SENSOR) versions[UI_SRC_SENSOR] = hardware_get_sensor_version();
+    if (bindings & UI_BIND_NETWORK) versions[UI_SRC_NETWORK] = wifi_get_version();
+}
+
+static void ui_read_state(ui_state_t *state) {
+    state->led_state = led_get_state();
+    state->button_state = button_read();
+    state->press_count = button_get_press_count();
+    
+    sensor_snapshot_t sensor;
+    hardware_get_sensor_snapshot(&sensor);
+    state->temperature = sensor.temperature;
+    state->humidity = sensor.humidity;
+    state->sensor_valid = sensor.valid;
+    state->ip = wifi_get_ip();
+    state->rssi = wifi_get_rssi();
+}
+
+void ui_set_screen(const ui_screen_t *screen) {
+    s_screen = screen;
+    s_force_render = true;
+    ESP_LOGI(TAG, "Pantalla activa: %s", screen ? screen->name : "(ninguna)");
+}
+
+void ui_invalidate(void) {
+    s_force_render = true;
+}
+
+// Hay cambios sin dibujar (p. ej. ui_poll() los aplazó por el tope de refresco)
+bool ui_is_dirty(void) {
+    if (s_screen == NULL) return false;
+    if (s_force_render) return true;
+    
+    uint32_t versions[UI_SRC_COUNT];
+    ui_read_versions(s_screen->bindings, versions);
+    return memcmp(versions, s_rendered_versions, sizeof(versions)) != 0;
+}
+
+// Redibuja la pantalla activa solo si cambió alguna de sus dependencias,
+// respetando UI_MIN_REFRESH_MS. Devuelve true si hubo render.
+bool ui_poll(void) {
+    if (s_screen == NULL) return false;
+    
+    uint32_t now = ui_now_ms();
+    uint32_t versions[UI_SRC_COUNT];
+    ui_read_versions(s_screen->bindings, versions);
+    
+    if (!s_force_render &&
+        memcmp(versions, s_rendered_versions, sizeof(versions)) == 0) {
+        return false;
+    }
+    // Cambio pendiente: se dibuja en un poll posterior si aún no toca
+    if (!s_force_render && (now - s_last_render_ms) < UI_MIN_REFRESH_MS) {
+        return false;
+    }
+    
+    ui_state_t state;
+    ui_read_state(&state);
+    s_screen->render(&state);
+    
+    memcpy(s_rendered_versions, versions, sizeof(versions));
+    s_force_render = false;
+    s_last_render_ms = now;
+    return true;
+}
+
+// ==================== PANTALLAS ====================
+
+static void render_button_debug(const ui_state_t *state) {
+    oled_show_button_debug(state->led_state, state->button_state);
+}
+
+static void render_combined_status(const ui_state_t *state) {
+    oled_show_combined_status(state->button_state, state->led_state,
+                              state->press_count, state->ip, state->rssi);
+}
+
+const ui_screen_t UI_SCREEN_BUTTON_DEBUG = {
+    .name = "button_debug",
+    .bindings = UI_BIND_LED | UI_BIND_BUTTON,
+    .render = render_button_debug,
+};
+
+const ui_screen_t UI_SCREEN_COMBINED_STATUS = {
+    .name = "combined_status",
+    .bindings = UI_BIND_LED | UI_BIND_BUTTON | UI_BIND_PRESS_COUNT | UI_BIND_NETWORK,
+    .render = render_combined_status,
+};
\ No newline at end of file
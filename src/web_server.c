@@ -3,258 +3,838 @@
 #include "esp_http_server.h"
 #include "hardware.h"
 #include "wifi_config.h"
+#include "sensor_history.h"
+#include "json_writer.h"
+#include "json_reader.h"
+#include "mqtt_app.h"
+#include "power.h"
+#include "esp_crc.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
 
 static const char *TAG = "WEB_SERVER";
 static httpd_handle_t server = NULL;
 
-// HTML con codificación UTF-8
-static const char* HTML_PAGE = 
-"<!DOCTYPE html>"
-"<html>"
-"<head>"
-"    <meta charset='UTF-8'>"
-"    <title>ESP32-C3 Control</title>"
-"    <meta name='viewport' content='width=device-width, initial-scale=1'>"
-"    <style>"
-"        body { font-family: Arial, sans-serif; margin: 20px; background: #f0f0f0; }"
-"        .container { max-width: 400px; margin: 0 auto; background: white; padding: 20px; border-radius: 10px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }"
-"        .status { padding: 10px; margin: 10px 0; border-radius: 5px; text-align: center; font-weight: bold; }"
-"        .led-on { background: #4CAF50; color: white; }"
-"        .led-off { background: #f44336; color: white; }"
-"        .wifi-good { background: #4CAF50; color: white; }"
-"        .wifi-weak { background: #FF9800; color: white; }"
-"        .wifi-poor { background: #f44336; color: white; }"
-"        .btn { background: #008CBA; color: white; padding: 12px; border: none; border-radius: 5px; cursor: pointer; margin: 5px; width: 100%; font-size: 16px; }"
-"        .btn:hover { background: #005f7a; }"
-"        .info { background: #e7f3ff; padding: 10px; border-radius: 5px; margin: 10px 0; }"
-"        .section { margin: 20px 0; }"
-"    </style>"
-"</head>"
-"<body>"
-"    <div class='container'>"
-"        <h1>ESP32-C3 Control</h1>"
-"        "
-"        <div class='info'>"
-"            <strong>IP:</strong> %s<br>"
-"            <strong>Senal WiFi:</strong> <span class='%s'>%d dBm</span>"
-"        </div>"
-"        "
-"        <div class='section'>"
-"            <h2>Estado del LED</h2>"
-"            <div class='status %s' id='ledStatus'>"
-"                LED: %s"
-"            </div>"
-"        </div>"
-"        "
-"        <div class='section'>"
-"            <h2>Control LED</h2>"
-"            <button class='btn' onclick='controlLED(1)'>ENCENDER LED</button>"
-"            <button class='btn' onclick='controlLED(0)'>APAGAR LED</button>"
-"            <button class='btn' onclick='controlLED(2)'>ALTERNAR LED</button>"
-        "        </div>"
-        "        "
-        "        <div class='section'>"
-        "            <h2>Informacion del Sistema</h2>"
-        "            <div class='info'>"
-        "                <strong>Pulsaciones del boton:</strong> <span id='pressCount'>%lu</span><br>"
-        "                <strong>Estado del boton:</strong> <span id='buttonState'>%s</span>"
-        "            </div>"
-        "        </div>"
-        "        "
-        "        <div class='section'>"
-        "            <h2>Sensor DHT11</h2>"
-        "            <div class='info'>"
-        "                <strong>Temperatura:</strong> <span id='temperature'>%.1f °C</span><br>"
-        "                <strong>Humedad:</strong> <span id='humidity'>%.1f %%</span><br>"
-        "                <strong>Estado:</strong> <span id='sensorStatus'>%s</span>"
-        "            </div>"
-        "        </div>"
-"        "
-"        <button class='btn' onclick='updateStatus()'>ACTUALIZAR TODO</button>"
-"        "
-"        <script>"
-"        function controlLED(action) {"
-"            fetch('/led', {"
-"                method: 'POST',"
-"                headers: { 'Content-Type': 'application/json' },"
-"                body: JSON.stringify({action: action})"
-"            })"
-"            .then(response => response.json())"
-"            .then(data => {"
-"                if(data.success) {"
-"                    updateStatus();"
-"                }"
-"            });"
-"        }"
-"        "
-"        function updateStatus() {"
-"            fetch('/status')"
-"            .then(response => response.json())"
-"            .then(data => {"
-"                // Actualizar LED"
-"                const ledStatus = document.getElementById('ledStatus');"
-"                ledStatus.className = 'status ' + (data.led_state ? 'led-on' : 'led-off');"
-"                ledStatus.textContent = 'LED: ' + (data.led_state ? 'ENCENDIDO' : 'APAGADO');"
-                "                "
-                "                // Actualizar informacion"
-                "                document.getElementById('pressCount').textContent = data.press_count;"
-                "                document.getElementById('buttonState').textContent = data.button_state ? 'PRESIONADO' : 'LIBERADO';"
-                "                "
-                "                // Actualizar datos del sensor DHT11"
-                "                if(data.sensor_valid) {"
-                "                    document.getElementById('temperature').textContent = data.temperature.toFixed(1) + ' °C';"
-                "                    document.getElementById('humidity').textContent = data.humidity.toFixed(1) + ' %';"
-                "                    document.getElementById('sensorStatus').textContent = 'VÁLIDO';"
-                "                } else {"
-                "                    document.getElementById('temperature').textContent = 'N/A';"
-                "                    document.getElementById('humidity').textContent = 'N/A';"
-                "                    document.getElementById('sensorStatus').textContent = 'NO DISPONIBLE';"
-                "                }"
-"            });"
-"        }"
-"        "
-"        // Actualizar automaticamente cada 3 segundos"
-"        setInterval(updateStatus, 3000);"
-"        "
-"        // Actualizar al cargar la pagina"
-"        updateStatus();"
-"        </script>"
-"    </div>"
-"</body>"
-"</html>";
-
-// Handler para página principal
+// Clientes suscritos a /ws. Solo se modifican en la tarea de httpd (al
+// abrir la conexión y al detectar que se cerró durante un envío).
+static int s_ws_fds[WEB_WS_MAX_CLIENTS];
+static volatile int s_ws_count = 0;
+static uint32_t s_push_count = 0;
+static uint32_t s_pushed_doc_version = 0;   // Último documento difundido
+
+// Último estado empujado (ver web_server_push_changes)
+static portMUX_TYPE s_push_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_pushed_version = 0;
+static int64_t s_pushed_us = 0;
+static bool s_push_queued = false;
+
+// Documento de estado compartido por /status y /ws. Solo se vuelve a
+// serializar cuando cambia alguna de sus entradas; mientras tanto todas las
+// peticiones envían el mismo buffer con el mismo ETag. s_status_lock lo
+// protege desde la comprobación hasta que termina el envío.
+typedef enum {
+    WEB_INPUT_STATE,        // web_state_version()
+    WEB_INPUT_METRICS,      // s_metrics_version
+    WEB_INPUT_WS_CLIENTS,
+    WEB_INPUT_COUNT
+} web_input_t;
+
+static SemaphoreHandle_t s_status_lock = NULL;
+static char s_status_doc[WEB_STATUS_MAX_LEN];
+static size_t s_status_len = 0;
+static char s_status_etag[12];
+static uint32_t s_status_crc = 0;
+static uint32_t s_status_version = 0;      // Cambia solo si cambia el contenido
+static uint32_t s_status_inputs[WEB_INPUT_COUNT];
+static uint32_t s_status_renders = 0;
+static uint32_t s_status_hits = 0;
+
+// Tarea de httpd, para vigilar su pila (ver web_server_log_stats)
+static TaskHandle_t s_httpd_task = NULL;
+
+// Rutas HTTP con sus medidas. Las que hacen envíos largos se atienden en
+// los trabajadores (async); el resto, incluido /led, en la tarea de httpd,
+// que así queda libre aunque haya clientes lentos.
+typedef enum {
+    WEB_ROUTE_ROOT,
+    WEB_ROUTE_STATUS,
+    WEB_ROUTE_LED,
+    WEB_ROUTE_HISTORY,
+    WEB_ROUTE_COUNT
+} web_route_id_t;
+
+typedef struct {
+    const char *name;
+    esp_err_t (*fn)(httpd_req_t *req);
+    bool async;
+    uint32_t requests;
+    uint32_t avg_us;                // Media móvil (1/8), desde que llega
+    uint32_t max_us;                // hasta que se termina de enviar
+} web_route_t;
+
+// Petición en espera de un trabajador
+typedef struct {
+    httpd_req_t *req;               // Copia de httpd_req_async_handler_begin()
+    web_route_t *route;
+    int64_t start_us;
+} web_job_t;
+
+static QueueHandle_t s_job_queue = NULL;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_queue_max_depth = 0;
+static uint32_t s_queue_max_wait_us = 0;
+static uint32_t s_queue_rejected = 0;
+
+// Métricas de MQTT y de bajo consumo tal como se publican. Varían en casi
+// cada lectura, así que se muestrean como mucho cada WEB_STATUS_METRICS_MS
+// y solo cuentan como cambio si alguna cifra publicada es distinta.
+typedef struct {
+    bool mqtt_connected;
+    uint32_t inflight;
+    uint32_t inflight_bytes;
+    uint32_t max_inflight;
+    uint32_t outbox_bytes;
+    uint32_t puback_avg_ms;
+    uint32_t puback_max_ms;
+    uint32_t timeouts;
+    uint32_t rejected;
+    uint32_t deferred;
+    uint32_t dropped;
+    uint32_t backlog;
+    bool light_sleep;
+    uint32_t wakeups_per_min;
+    uint32_t sleep_permille;
+} web_metrics_t;
+
+static web_metrics_t s_metrics;
+static uint32_t s_metrics_version = 0;
+static int64_t s_metrics_sampled_us = 0;
+
+// Interfaz web (web/index.html) comprimida con gzip al compilar. La página
+// no lleva datos: los pide a /status, así que es la misma para todos y se
+// puede cachear en el navegador.
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
+
+// ETag fuerte: CRC32 del contenido comprimido, calculado una vez al arrancar
+static char s_index_etag[12];
+
+// Handler para página principal. Con un ETag válido en If-None-Match
+// responde 304 sin cuerpo; si no, envía el recurso tal cual está en flash.
 static esp_err_t root_get_handler(httpd_req_t *req) {
-    system_status_t status = web_get_system_status();
+    httpd_resp_set_hdr(req, "ETag", s_index_etag);
+    httpd_resp_set_hdr(req, "Cache-Control", WEB_INDEX_CACHE_CONTROL);
     
-    // Determinar clase CSS para senal WiFi
-    const char* wifi_class = "wifi-poor";
-    int rssi = wifi_get_rssi();
-    if (rssi > -60) wifi_class = "wifi-good";
-    else if (rssi > -75) wifi_class = "wifi-weak";
-    
-    char html_response[4096];
-    int len = snprintf(html_response, sizeof(html_response), HTML_PAGE,
-             status.ip_address,
-             wifi_class, rssi,
-             status.led_state ? "led-on" : "led-off",
-             status.led_state ? "ENCENDIDO" : "APAGADO",
-             status.press_count,
-             status.button_state ? "PRESIONADO" : "LIBERADO",
-             status.sensor_valid ? status.temperature : 0.0f,
-             status.sensor_valid ? status.humidity : 0.0f,
-             status.sensor_valid ? "VÁLIDO" : "NO DISPONIBLE");
-    
-    // Configurar headers para UTF-8
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, s_index_etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+    
+    // Todos los navegadores aceptan gzip; no se guarda una copia sin comprimir
     httpd_resp_set_type(req, "text/html; charset=utf-8");
-    httpd_resp_set_hdr(req, "Content-Type", "text/html; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)index_html_gz_start, index_html_gz_end - index_html_gz_start);
+}
+
+// Serializa el documento de estado con las métricas ya muestreadas.
+// Devuelve la longitud o 0 si no cabe en el buffer.
+static size_t web_status_render(char *buf, size_t size) {
+    system_status_t status = web_get_system_status();
+    const web_metrics_t *m = &s_metrics;
     
-    httpd_resp_send(req, html_response, HTTPD_RESP_USE_STRLEN);
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_obj_begin(&w);
+    json_kv_bool(&w, "led_state", status.led_state);
+    json_kv_bool(&w, "button_state", status.button_state);
+    json_kv_uint(&w, "press_count", status.press_count);
+    json_kv_str(&w, "ip_address", status.ip_address);
+    json_kv_int(&w, "rssi", wifi_get_rssi());
+    json_kv_fixed(&w, "temperature", status.temperature_x10, 1);
+    json_kv_fixed(&w, "humidity", status.humidity_x10, 1);
+    json_kv_bool(&w, "sensor_valid", status.sensor_valid);
+    json_kv_uint(&w, "ws_clients", s_ws_count);
     
-    ESP_LOGI(TAG, "Pagina web enviada (%d bytes)", len);
-    return ESP_OK;
+    // Cola de salida MQTT: profundidad, latencia de PUBACK y pérdidas
+    json_key(&w, "mqtt");
+    json_obj_begin(&w);
+    json_kv_bool(&w, "connected", m->mqtt_connected);
+    json_kv_uint(&w, "inflight", m->inflight);
+    json_kv_uint(&w, "inflight_bytes", m->inflight_bytes);
+    json_kv_uint(&w, "max_inflight", m->max_inflight);
+    json_kv_uint(&w, "outbox_bytes", m->outbox_bytes);
+    json_kv_uint(&w, "puback_avg_ms", m->puback_avg_ms);
+    json_kv_uint(&w, "puback_max_ms", m->puback_max_ms);
+    json_kv_uint(&w, "timeouts", m->timeouts);
+    json_kv_uint(&w, "rejected", m->rejected);
+    json_kv_uint(&w, "deferred", m->deferred);
+    json_kv_uint(&w, "dropped", m->dropped);
+    json_kv_uint(&w, "backlog", m->backlog);
+    json_obj_end(&w);
+    
+    // Bajo consumo: despertares y tiempo en light sleep del último minuto
+    json_key(&w, "power");
+    json_obj_begin(&w);
+    json_kv_bool(&w, "light_sleep", m->light_sleep);
+    json_kv_uint(&w, "wakeups_per_min", m->wakeups_per_min);
+    json_kv_fixed(&w, "sleep_pct", (int32_t)m->sleep_permille, 1);
+    json_obj_end(&w);
+    
+    json_obj_end(&w);
+    return json_writer_finish(&w);
 }
 
-// Handler para estado del sistema (JSON)
-static esp_err_t status_get_handler(httpd_req_t *req) {
-    system_status_t status = web_get_system_status();
+// Suma de contadores que solo crecen: cambia si cambia cualquiera
+static uint32_t web_state_version(void) {
+    return led_get_version() + button_get_version() + button_get_press_count() +
+           hardware_get_sensor_version() + wifi_get_version();
+}
+
+static void web_metrics_sample(void) {
+    int64_t now = esp_timer_get_time();
+    if (s_metrics_sampled_us != 0 && now - s_metrics_sampled_us < (int64_t)WEB_STATUS_METRICS_MS * 1000) {
+        return;
+    }
+    s_metrics_sampled_us = now;
     
-    char json_response[512];
-    snprintf(json_response, sizeof(json_response),
-             "{\"led_state\":%s,\"button_state\":%s,\"press_count\":%lu,\"ip_address\":\"%s\",\"rssi\":%d,\"temperature\":%.1f,\"humidity\":%.1f,\"sensor_valid\":%s}",
-             status.led_state ? "true" : "false",
-             status.button_state ? "true" : "false",
-             status.press_count,
-             status.ip_address,
-             wifi_get_rssi(),
-             status.temperature,
-             status.humidity,
-             status.sensor_valid ? "true" : "false");
+    mqtt_app_stats_t mqtt;
+    mqtt_app_get_stats(&mqtt);
+    power_stats_t power;
+    power_get_stats(&power);
     
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    web_metrics_t m;
+    memset(&m, 0, sizeof(m));   // El relleno también se compara
+    m.mqtt_connected = mqtt.connected;
+    m.inflight = mqtt.inflight.inflight;
+    m.inflight_bytes = mqtt.inflight.inflight_bytes;
+    m.max_inflight = mqtt.inflight.max_inflight;
+    m.outbox_bytes = mqtt.outbox_bytes;
+    m.puback_avg_ms = mqtt.inflight.puback_avg_ms;
+    m.puback_max_ms = mqtt.inflight.puback_max_ms;
+    m.timeouts = mqtt.inflight.timeouts + mqtt.inflight.expired;
+    m.rejected = mqtt.inflight.rejected[MQTT_CLASS_COMMAND] +
+                 mqtt.inflight.rejected[MQTT_CLASS_TELEMETRY] +
+                 mqtt.inflight.rejected[MQTT_CLASS_BACKLOG];
+    m.deferred = mqtt.deferred;
+    m.dropped = mqtt.dropped;
+    m.backlog = mqtt.backlog_pending;
+    m.light_sleep = power.light_sleep;
+    m.wakeups_per_min = power.wakeups_per_min;
+    m.sleep_permille = power.sleep_permille;
     
-    return ESP_OK;
+    if (memcmp(&m, &s_metrics, sizeof(m)) != 0) {
+        s_metrics = m;
+        s_metrics_version++;
+    }
 }
 
-// Handler para controlar el LED
-static esp_err_t led_post_handler(httpd_req_t *req) {
-    char buf[100];
-    int ret = httpd_req_recv(req, buf, sizeof(buf)-1);
+// Pone al día el documento compartido; llamar con s_status_lock tomado.
+// Las versiones se leen antes de serializar: si algo cambia a mitad, el
+// documento ya lo incluye o se regenera en la siguiente petición.
+static bool web_status_refresh(void) {
+    web_metrics_sample();
+    
+    uint32_t inputs[WEB_INPUT_COUNT];
+    inputs[WEB_INPUT_STATE] = web_state_version();
+    inputs[WEB_INPUT_METRICS] = s_metrics_version;
+    inputs[WEB_INPUT_WS_CLIENTS] = s_ws_count;
+    if (s_status_len > 0 && memcmp(inputs, s_status_inputs, sizeof(inputs)) == 0) {
+        s_status_hits++;
+        return true;
+    }
     
-    if (ret <= 0) {
+    s_status_len = web_status_render(s_status_doc, sizeof(s_status_doc));
+    if (s_status_len == 0) {
+        ESP_LOGE(TAG, "El documento de estado no cabe en %d bytes", WEB_STATUS_MAX_LEN);
+        return false;
+    }
+    s_status_renders++;
+    memcpy(s_status_inputs, inputs, sizeof(inputs));
+    
+    // Una entrada puede cambiar sin que cambie el texto (LED encendido y
+    // apagado entre dos peticiones): entonces se conservan versión y ETag
+    uint32_t crc = esp_crc32_le(0, (const uint8_t *)s_status_doc, s_status_len);
+    if (crc != s_status_crc || s_status_version == 0) {
+        s_status_crc = crc;
+        s_status_version++;
+        snprintf(s_status_etag, sizeof(s_status_etag), "\"%08lx\"", crc);
+    }
+    return true;
+}
+
+// Handler para estado del sistema (JSON). Responde 304 sin cuerpo si el
+// cliente ya tiene el documento actual.
+static esp_err_t status_get_handler(httpd_req_t *req) {
+    xSemaphoreTake(s_status_lock, portMAX_DELAY);
+    if (!web_status_refresh()) {
+        xSemaphoreGive(s_status_lock);
         httpd_resp_send_500(req);
         return ESP_FAIL;
     }
     
-    buf[ret] = '\0';
+    httpd_resp_set_hdr(req, "ETag", s_status_etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
     
-    // Parseo simple
-    int action = -1;
-    if (strstr(buf, "\"action\":0")) action = 0;
-    else if (strstr(buf, "\"action\":1")) action = 1;
-    else if (strstr(buf, "\"action\":2")) action = 2;
+    esp_err_t ret;
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, s_status_etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        ret = httpd_resp_send(req, NULL, 0);
+    } else {
+        httpd_resp_set_type(req, "application/json");
+        ret = httpd_resp_send(req, s_status_doc, s_status_len);
+    }
+    xSemaphoreGive(s_status_lock);
+    return ret;
+}
+
+// Envía el estado a los clientes de /ws (o solo a only_fd si es >= 0). Se
+// ejecuta en la tarea de httpd vía httpd_queue_work(): todos reciben el
+// documento compartido, la difusión se omite si no cambió desde la última
+// y los clientes cerrados se dan de baja.
+static void web_push_work(void *arg) {
+    int only_fd = (int)(intptr_t)arg;
+    if (only_fd < 0) {
+        portENTER_CRITICAL(&s_push_mux);
+        s_push_queued = false;
+        portEXIT_CRITICAL(&s_push_mux);
+    }
+    if (server == NULL || s_ws_count == 0) return;
     
-    bool success = true;
-    char message[50] = "OK";
+    xSemaphoreTake(s_status_lock, portMAX_DELAY);
+    if (!web_status_refresh() ||
+        (only_fd < 0 && s_status_version == s_pushed_doc_version)) {
+        xSemaphoreGive(s_status_lock);
+        return;
+    }
+    if (only_fd < 0) s_pushed_doc_version = s_status_version;
     
-    switch (action) {
-        case 0: // Apagar
-            led_set(LED_OFF);
-            strcpy(message, "LED apagado");
-            break;
-        case 1: // Encender
-            led_set(LED_ON);
-            strcpy(message, "LED encendido");
-            break;
-        case 2: // Alternar
-            led_toggle();
-            strcpy(message, "LED alternado");
-            break;
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)s_status_doc,
+        .len = s_status_len,
+    };
+    s_push_count++;
+    int i = 0;
+    while (i < s_ws_count) {
+        int fd = s_ws_fds[i];
+        if (only_fd >= 0 && fd != only_fd) {
+            i++;
+            continue;
+        }
+        if (httpd_ws_get_fd_info(server, fd) != HTTPD_WS_CLIENT_WEBSOCKET ||
+            httpd_ws_send_frame_async(server, fd, &frame) != ESP_OK) {
+            ESP_LOGI(TAG, "Cliente /ws %d desconectado", fd);
+            s_ws_fds[i] = s_ws_fds[--s_ws_count];
+            continue;
+        }
+        i++;
+    }
+    xSemaphoreGive(s_status_lock);
+}
+
+void web_server_push_changes(void) {
+    if (server == NULL || s_ws_count == 0) return;
+    
+    uint32_t version = web_state_version();
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_push_mux);
+    bool push = !s_push_queued &&
+                (version != s_pushed_version || now - s_pushed_us >= (int64_t)WEB_WS_REFRESH_MS * 1000);
+    if (push) {
+        s_push_queued = true;
+        s_pushed_version = version;
+        s_pushed_us = now;
+    }
+    portEXIT_CRITICAL(&s_push_mux);
+    
+    if (push && httpd_queue_work(server, web_push_work, (void *)(intptr_t)-1) != ESP_OK) {
+        portENTER_CRITICAL(&s_push_mux);
+        s_push_queued = false;
+        portEXIT_CRITICAL(&s_push_mux);
+    }
+}
+
+// Handler de /ws. La primera llamada es el GET del handshake: el cliente se
+// suscribe y recibe el estado actual. Después llegan sus tramas, que no se
+// usan (cierre y ping los gestiona httpd).
+static esp_err_t ws_handler(httpd_req_t *req) {
+    if (req->method == HTTP_GET) {
+        int fd = httpd_req_to_sockfd(req);
+        // Un descriptor reutilizado de un cliente que se fue sin avisar
+        for (int i = 0; i < s_ws_count; i++) {
+            if (s_ws_fds[i] == fd) s_ws_fds[i--] = s_ws_fds[--s_ws_count];
+        }
+        if (s_ws_count >= WEB_WS_MAX_CLIENTS) {
+            ESP_LOGW(TAG, "Demasiados clientes /ws, se rechaza %d", fd);
+            return ESP_FAIL;
+        }
+        s_ws_fds[s_ws_count++] = fd;
+        ESP_LOGI(TAG, "Cliente /ws %d suscrito (%d)", fd, s_ws_count);
+        return httpd_queue_work(req->handle, web_push_work, (void *)(intptr_t)fd);
+    }
+    
+    uint8_t payload[32];
+    httpd_ws_frame_t frame = { .payload = payload };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) return ret;
+    if (frame.len > sizeof(payload)) {
+        return ESP_FAIL;    // Cierra la conexión: nadie debería enviar tanto
+    }
+    return frame.len > 0 ? httpd_ws_recv_frame(req, &frame, sizeof(payload)) : ESP_OK;
+}
+
+// Cuerpo de /led, leído con json_reader sin guardar el documento. Admite
+// una acción suelta o una secuencia:
+//   {"action":1}
+//   {"actions":[{"action":"on"},{"action":2,"delay_ms":500},0]}
+// Cada acción es 0/"off", 1/"on" o 2/"toggle"; delay_ms es la espera desde
+// el paso anterior.
+#define LED_ACTION_NONE     0xFF
+
+typedef struct {
+    uint8_t action;
+    uint32_t delay_ms;
+} web_led_step_t;
+
+typedef enum {
+    LED_FIELD_NONE,
+    LED_FIELD_ACTION,
+    LED_FIELD_ACTIONS,
+    LED_FIELD_DELAY,
+} led_field_t;
+
+typedef struct {
+    web_led_step_t steps[WEB_LED_MAX_ACTIONS];
+    int count;
+    bool in_actions;            // Dentro del array "actions"
+    bool in_step;               // Dentro de un objeto de ese array
+    led_field_t field;          // A qué campo va el próximo valor
+    const char *error;
+} led_request_t;
+
+// Secuencia en curso: los pasos con espera los ejecuta un esp_timer. Cada
+// paso guarda su instante absoluto, así un disparo que llegue tarde (p. ej.
+// de una secuencia ya sustituida) no adelanta nada.
+static SemaphoreHandle_t s_led_seq_lock = NULL;
+static esp_timer_handle_t s_led_seq_timer = NULL;
+static uint8_t s_led_seq_actions[WEB_LED_MAX_ACTIONS];
+static int64_t s_led_seq_due_us[WEB_LED_MAX_ACTIONS];
+static int s_led_seq_len = 0;
+static int s_led_seq_next = 0;
+
+static web_led_step_t *led_add_step(led_request_t *q) {
+    if (q->count >= WEB_LED_MAX_ACTIONS) {
+        q->error = "Demasiadas acciones";
+        return NULL;
+    }
+    web_led_step_t *step = &q->steps[q->count++];
+    step->action = LED_ACTION_NONE;
+    step->delay_ms = 0;
+    return step;
+}
+
+// Callback de json_reader: solo mira las claves conocidas y salta el resto
+static bool led_parse_token(void *ctx, const json_token_t *tok) {
+    led_request_t *q = (led_request_t *)ctx;
+    led_field_t field = q->field;
+    q->field = LED_FIELD_NONE;
+    
+    switch (tok->type) {
+        case JSON_TOK_KEY:
+            if (tok->depth == 1 && strcmp(tok->text, "action") == 0) q->field = LED_FIELD_ACTION;
+            else if (tok->depth == 1 && strcmp(tok->text, "actions") == 0) q->field = LED_FIELD_ACTIONS;
+            else if (q->in_step && tok->depth == 3 && strcmp(tok->text, "action") == 0) q->field = LED_FIELD_ACTION;
+            else if (q->in_step && tok->depth == 3 && strcmp(tok->text, "delay_ms") == 0) q->field = LED_FIELD_DELAY;
+            return true;
+        case JSON_TOK_ARR_BEGIN:
+            if (field == LED_FIELD_ACTIONS) q->in_actions = true;
+            return true;
+        case JSON_TOK_ARR_END:
+            if (tok->depth == 1) q->in_actions = false;
+            return true;
+        case JSON_TOK_OBJ_BEGIN:
+            if (q->in_actions && tok->depth == 2) {
+                q->in_step = true;
+                return led_add_step(q) != NULL;
+            }
+            return true;
+        case JSON_TOK_OBJ_END:
+            if (q->in_step && tok->depth == 2) {
+                q->in_step = false;
+                if (q->steps[q->count - 1].action == LED_ACTION_NONE) {
+                    q->error = "Falta action";
+                    return false;
+                }
+            }
+            return true;
         default:
-            success = false;
-            strcpy(message, "Acción no válida");
             break;
     }
     
-    char response[128];
-    snprintf(response, sizeof(response),
-             "{\"success\":%s,\"message\":\"%s\",\"led_state\":%s}",
-             success ? "true" : "false",
-             message,
-             led_get_state() ? "true" : "false");
+    // Valores: forma corta [1, 0, "toggle"] dentro de "actions"
+    bool short_form = q->in_actions && tok->depth == 2;
+    if (field == LED_FIELD_ACTION || short_form) {
+        int action = led_action_from_token(tok);
+        if (action < 0) {
+            q->error = "Acción no válida";
+            return false;
+        }
+        web_led_step_t *step = (q->in_step && !short_form) ? &q->steps[q->count - 1] : led_add_step(q);
+        if (step == NULL) return false;
+        step->action = action;
+    } else if (field == LED_FIELD_DELAY) {
+        int32_t delay;
+        if (!json_token_to_int(tok, &delay) || delay < 0 || delay > WEB_LED_MAX_DELAY_MS) {
+            q->error = "delay_ms no válido";
+            return false;
+        }
+        q->steps[q->count - 1].delay_ms = delay;
+    }
+    return true;
+}
+
+// Ejecuta los pasos de la secuencia que ya tocan y arma el temporizador
+// para el siguiente. Llamar con s_led_seq_lock tomado.
+static int led_seq_run_due(bool results[], int max_results) {
+    int64_t now = esp_timer_get_time();
+    int done = 0;
+    while (s_led_seq_next < s_led_seq_len) {
+        int64_t due = s_led_seq_due_us[s_led_seq_next];
+        if (due > now) {
+            esp_timer_stop(s_led_seq_timer);
+            esp_timer_start_once(s_led_seq_timer, due - now);
+            break;
+        }
+        led_apply_action(s_led_seq_actions[s_led_seq_next]);
+        s_led_seq_next++;
+        if (done < max_results) results[done] = led_get_state();
+        done++;
+    }
+    return done;
+}
+
+static void led_seq_timer_cb(void *arg) {
+    xSemaphoreTake(s_led_seq_lock, portMAX_DELAY);
+    led_seq_run_due(NULL, 0);
+    xSemaphoreGive(s_led_seq_lock);
+    web_server_push_changes();
+}
+
+// Handler para controlar el LED. El cuerpo se lee por trozos y se analiza
+// según llega, así que no importa cómo venga partido ni su tamaño (hasta
+// WEB_LED_MAX_BODY). Responde con el estado tras cada paso inmediato; los
+// que llevan espera se ejecutan después y sustituyen a cualquier secuencia
+// anterior.
+static esp_err_t led_post_handler(httpd_req_t *req) {
+    led_request_t q = { 0 };
+    json_reader_t reader;
+    json_reader_init(&reader, led_parse_token, &q);
+    
+    const char *error = NULL;
+    if (req->content_len > WEB_LED_MAX_BODY) {
+        error = "Cuerpo demasiado grande";
+    }
+    
+    char chunk[WEB_LED_RECV_CHUNK];
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+    while (error == NULL && remaining > 0) {
+        int ret = httpd_req_recv(req, chunk, remaining < sizeof(chunk) ? remaining : sizeof(chunk));
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < 3) {
+            continue;
+        }
+        if (ret <= 0) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        remaining -= ret;
+        if (!json_reader_feed(&reader, chunk, ret)) break;
+    }
+    if (error == NULL && !json_reader_finish(&reader)) {
+        error = q.error ? q.error : json_reader_error_str(reader.error);
+    }
+    if (error == NULL && q.count == 0) {
+        error = "Acción no válida";
+    }
+    
+    bool results[WEB_LED_MAX_ACTIONS];
+    int done = 0;
+    int scheduled = 0;
+    if (error == NULL) {
+        xSemaphoreTake(s_led_seq_lock, portMAX_DELAY);
+        esp_timer_stop(s_led_seq_timer);
+        int64_t due = esp_timer_get_time();
+        for (int i = 0; i < q.count; i++) {
+            due += (int64_t)q.steps[i].delay_ms * 1000;
+            s_led_seq_actions[i] = q.steps[i].action;
+            s_led_seq_due_us[i] = due;
+        }
+        s_led_seq_len = q.count;
+        s_led_seq_next = 0;
+        done = led_seq_run_due(results, WEB_LED_MAX_ACTIONS);
+        scheduled = s_led_seq_len - s_led_seq_next;
+        xSemaphoreGive(s_led_seq_lock);
+    }
+    
+    const char *message = error;
+    // Según lo que realmente se hizo: un paso con delay_ms solo queda programado
+    if (error == NULL && done == 1 && scheduled == 0) {
+        static const char *const names[] = { "LED apagado", "LED encendido", "LED alternado" };
+        message = names[q.steps[0].action];
+    } else if (error == NULL && scheduled > 0) {
+        message = (done == 0 && scheduled == 1) ? "Acción programada" : "Secuencia en curso";
+    } else if (error == NULL) {
+        message = "Secuencia ejecutada";
+    }
+    
+    char response[192];
+    json_writer_t w;
+    json_writer_init(&w, response, sizeof(response));
+    json_obj_begin(&w);
+    json_kv_bool(&w, "success", error == NULL);
+    json_kv_str(&w, "message", message);
+    json_kv_bool(&w, "led_state", led_get_state());
+    if (error == NULL) {
+        json_key(&w, "results");
+        json_arr_begin(&w);
+        for (int i = 0; i < done; i++) {
+            json_put_bool(&w, results[i]);
+        }
+        json_arr_end(&w);
+        json_kv_uint(&w, "scheduled", scheduled);
+    }
+    json_obj_end(&w);
+    
+    // Cabe de sobra (8 resultados y el mensaje más largo), pero un 200
+    // vacío no debe pasar por respuesta válida. Las acciones ya se
+    // aplicaron, así que el aviso por /ws sale igualmente.
+    size_t len = json_writer_finish(&w);
+    esp_err_t ret = ESP_OK;
+    if (len == 0) {
+        httpd_resp_send_500(req);
+        ret = ESP_FAIL;
+    } else {
+        if (error != NULL) {
+            httpd_resp_set_status(req, "400 Bad Request");
+        }
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_send(req, response, len);
+    }
+    
+    // Los demás paneles se enteran por /ws sin esperar
+    web_server_push_changes();
+    return ret;
+}
+
+// Handler para el histórico del sensor (JSON, enviado por trozos)
+// GET /history?tier=raw|1m|15m&from=<s>&to=<s>
+// Cada punto: [inicio_s, tmin, tmax, tavg, hmin, hmax, havg] en décimas
+static esp_err_t history_get_handler(httpd_req_t *req) {
+    sensor_tier_t tier = SENSOR_TIER_RAW;
+    uint32_t from = 0;
+    uint32_t to = UINT32_MAX;
+    
+    char query[64];
+    char param[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "tier", param, sizeof(param)) == ESP_OK) {
+            for (int t = 0; t < SENSOR_TIER_COUNT; t++) {
+                if (strcmp(param, sensor_history_tier_name(t)) == 0) tier = t;
+            }
+        }
+        if (httpd_query_key_value(query, "from", param, sizeof(param)) == ESP_OK) {
+            from = strtoul(param, NULL, 10);
+        }
+        if (httpd_query_key_value(query, "to", param, sizeof(param)) == ESP_OK) {
+            to = strtoul(param, NULL, 10);
+        }
+    }
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
     
+    // Un solo escritor para toda la respuesta: tras enviar cada trozo se
+    // vacía el buffer pero se conserva el anidamiento (y por tanto las comas)
+    char chunk[WEB_HISTORY_CHUNK];
+    json_writer_t w;
+    json_writer_init(&w, chunk, sizeof(chunk));
+    json_obj_begin(&w);
+    json_kv_str(&w, "tier", sensor_history_tier_name(tier));
+    json_kv_uint(&w, "period", sensor_history_tier_period(tier));
+    json_key(&w, "points");
+    json_arr_begin(&w);
+    if (w.overflow) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    
+    sensor_rollup_t points[8];
+    size_t n;
+    do {
+        n = sensor_history_query(tier, from, to, points, sizeof(points) / sizeof(points[0]));
+        for (size_t i = 0; i < n; i++) {
+            const sensor_rollup_t *p = &points[i];
+            json_arr_begin(&w);
+            json_put_uint(&w, p->start_s);
+            json_put_int(&w, p->temp_min_x10);
+            json_put_int(&w, p->temp_max_x10);
+            json_put_int(&w, p->temp_avg_x10);
+            json_put_uint(&w, p->hum_min_x10);
+            json_put_uint(&w, p->hum_max_x10);
+            json_put_uint(&w, p->hum_avg_x10);
+            json_arr_end(&w);
+            if (w.overflow) {
+                return ESP_FAIL;
+            }
+            if (w.size - w.len < WEB_HISTORY_POINT_MAX) {
+                if (httpd_resp_send_chunk(req, chunk, w.len) != ESP_OK) {
+                    return ESP_FAIL;
+                }
+                json_writer_reset_buffer(&w);
+            }
+        }
+        if (n > 0) from = points[n - 1].start_s + 1;
+    } while (n == sizeof(points) / sizeof(points[0]));
+    
+    // El cierre siempre cabe: se envió antes si quedaba menos que un punto
+    json_arr_end(&w);
+    json_obj_end(&w);
+    // Un trozo de longitud 0 cerraría la respuesta como si estuviera
+    // completa: ante un desbordamiento se corta la conexión sin cerrarla
+    size_t len = json_writer_finish(&w);
+    if (len == 0 || httpd_resp_send_chunk(req, chunk, len) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    httpd_resp_send_chunk(req, NULL, 0);
     return ESP_OK;
 }
 
+static web_route_t s_routes[WEB_ROUTE_COUNT] = {
+    [WEB_ROUTE_ROOT]    = { .name = "/",        .fn = root_get_handler,    .async = true },
+    [WEB_ROUTE_STATUS]  = { .name = "/status",  .fn = status_get_handler,  .async = false },
+    [WEB_ROUTE_LED]     = { .name = "/led",     .fn = led_post_handler,    .async = false },
+    [WEB_ROUTE_HISTORY] = { .name = "/history", .fn = history_get_handler, .async = true },
+};
+
+static void web_route_record(web_route_t *route, int64_t start_us) {
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start_us);
+    portENTER_CRITICAL(&s_stats_mux);
+    route->requests++;
+    route->avg_us = route->requests == 1 ? us
+        : route->avg_us + ((int32_t)us - (int32_t)route->avg_us) / 8;
+    if (us > route->max_us) route->max_us = us;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+// Trabajador: atiende peticiones pasadas por web_route_handler() con la
+// conexión ya fuera del bucle de httpd
+static void web_worker_task(void *arg) {
+    web_job_t job;
+    for (;;) {
+        xQueueReceive(s_job_queue, &job, portMAX_DELAY);
+        
+        uint32_t wait_us = (uint32_t)(esp_timer_get_time() - job.start_us);
+        portENTER_CRITICAL(&s_stats_mux);
+        if (wait_us > s_queue_max_wait_us) s_queue_max_wait_us = wait_us;
+        portEXIT_CRITICAL(&s_stats_mux);
+        
+        // Como httpd con un handler síncrono: un fallo cierra la conexión,
+        // así una respuesta chunked a medias no parece completa
+        if (job.route->fn(job.req) != ESP_OK) {
+            httpd_sess_trigger_close(job.req->handle, httpd_req_to_sockfd(job.req));
+        }
+        web_route_record(job.route, job.start_us);
+        httpd_req_async_handler_complete(job.req);
+    }
+}
+
+// Handler común de las rutas: mide la latencia y, en las asíncronas, pasa
+// la petición a la cola de los trabajadores. Con la cola llena responde
+// 503 en vez de bloquear la tarea de httpd.
+static esp_err_t web_route_handler(httpd_req_t *req) {
+    web_route_t *route = (web_route_t *)req->user_ctx;
+    int64_t start_us = esp_timer_get_time();
+    
+    if (route->async && s_job_queue != NULL) {
+        // Solo la tarea de httpd encola: si ahora hay hueco, lo seguirá habiendo
+        if (uxQueueSpacesAvailable(s_job_queue) == 0) {
+            portENTER_CRITICAL(&s_stats_mux);
+            s_queue_rejected++;
+            portEXIT_CRITICAL(&s_stats_mux);
+            httpd_resp_set_status(req, "503 Service Unavailable");
+            httpd_resp_set_hdr(req, "Retry-After", "1");
+            return httpd_resp_send(req, NULL, 0);
+        }
+        
+        web_job_t job = { .route = route, .start_us = start_us };
+        if (httpd_req_async_handler_begin(req, &job.req) == ESP_OK) {
+            xQueueSend(s_job_queue, &job, 0);
+            uint32_t depth = uxQueueMessagesWaiting(s_job_queue);
+            portENTER_CRITICAL(&s_stats_mux);
+            if (depth > s_queue_max_depth) s_queue_max_depth = depth;
+            portEXIT_CRITICAL(&s_stats_mux);
+            return ESP_OK;
+        }
+        // Sin memoria para la copia: se atiende aquí mismo
+    }
+    
+    esp_err_t ret = route->fn(req);
+    web_route_record(route, start_us);
+    return ret;
+}
+
 // Configuración de rutas HTTP
 static const httpd_uri_t root = {
     .uri       = "/",
     .method    = HTTP_GET,
-    .handler   = root_get_handler,
-    .user_ctx  = NULL
+    .handler   = web_route_handler,
+    .user_ctx  = &s_routes[WEB_ROUTE_ROOT]
 };
 
 static const httpd_uri_t status = {
     .uri       = "/status",
     .method    = HTTP_GET,
-    .handler   = status_get_handler,
-    .user_ctx  = NULL
+    .handler   = web_route_handler,
+    .user_ctx  = &s_routes[WEB_ROUTE_STATUS]
+};
+
+static const httpd_uri_t history = {
+    .uri       = "/history",
+    .method    = HTTP_GET,
+    .handler   = web_route_handler,
+    .user_ctx  = &s_routes[WEB_ROUTE_HISTORY]
+};
+
+static const httpd_uri_t ws = {
+    .uri          = "/ws",
+    .method       = HTTP_GET,
+    .handler      = ws_handler,
+    .user_ctx     = NULL,
+    .is_websocket = true
 };
 
 static const httpd_uri_t led_control = {
     .uri       = "/led",
     .method    = HTTP_POST,
-    .handler   = led_post_handler,
-    .user_ctx  = NULL
+    .handler   = web_route_handler,
+    .user_ctx  = &s_routes[WEB_ROUTE_LED]
 };
 
+static void web_note_task(void *arg) {
+    s_httpd_task = xTaskGetCurrentTaskHandle();
+}
+
 void web_server_start(void) {
     ESP_LOGI(TAG, "🔧 Iniciando servidor web...");
     
@@ -263,10 +843,50 @@ void web_server_start(void) {
         return;
     }
     
+    if (s_status_lock == NULL) {
+        s_status_lock = xSemaphoreCreateMutex();
+    }
+    
+    if (s_led_seq_timer == NULL) {
+        s_led_seq_lock = xSemaphoreCreateMutex();
+        const esp_timer_create_args_t args = {
+            .callback = led_seq_timer_cb,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "led_seq",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&args, &s_led_seq_timer));
+    }
+    
+    // Los trabajadores sobreviven a web_server_stop(); se crean una vez
+    if (s_job_queue == NULL) {
+        s_job_queue = xQueueCreate(WEB_WORKER_QUEUE_LEN, sizeof(web_job_t));
+        int workers = 0;
+        for (int i = 0; s_job_queue != NULL && i < WEB_WORKER_COUNT; i++) {
+            char name[12];
+            snprintf(name, sizeof(name), "web_wrk%d", i);
+            if (xTaskCreate(web_worker_task, name, WEB_WORKER_STACK_SIZE, NULL,
+                            WEB_WORKER_PRIORITY, NULL) == pdPASS) {
+                workers++;
+            }
+        }
+        if (workers == 0) {
+            // Sin trabajadores todas las rutas se atienden en la tarea de httpd
+            ESP_LOGE(TAG, "No se pudieron crear los trabajadores web");
+            if (s_job_queue != NULL) vQueueDelete(s_job_queue);
+            s_job_queue = NULL;
+        }
+    }
+    snprintf(s_index_etag, sizeof(s_index_etag), "\"%08lx\"",
+             esp_crc32_le(0, index_html_gz_start, index_html_gz_end - index_html_gz_start));
+    
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.lru_purge_enable = true;
     config.server_port = 80;
-    config.stack_size = 8192; // Aumentar stack size por si acaso
+    // Pila por defecto (4 KB). La página y /history se sirven en los
+    // trabajadores y /status del buffer compartido; el handler más pesado de
+    // esta tarea es POST /led, que tiene en la pila el trozo de lectura, el
+    // json_reader_t, el led_request_t y la respuesta (~430 bytes en total).
+    // La pila libre mínima sale periódicamente en web_server_log_stats().
     
     ESP_LOGI(TAG, "📝 Configurando servidor en puerto %d...", config.server_port);
     
@@ -284,20 +904,56 @@ void web_server_start(void) {
         ret = httpd_register_uri_handler(server, &led_control);
         ESP_LOGI(TAG, "📄 Handler led: %s", esp_err_to_name(ret));
         
+        ret = httpd_register_uri_handler(server, &history);
+        ESP_LOGI(TAG, "📄 Handler history: %s", esp_err_to_name(ret));
+        
+        ret = httpd_register_uri_handler(server, &ws);
+        ESP_LOGI(TAG, "📄 Handler ws: %s", esp_err_to_name(ret));
+        
+        httpd_queue_work(server, web_note_task, NULL);
+        
         ESP_LOGI(TAG, "✅ Servidor web INICIADO correctamente");
         ESP_LOGI(TAG, "🌐 URLs disponibles:");
         ESP_LOGI(TAG, "   http://%s/", wifi_get_ip());
         ESP_LOGI(TAG, "   http://%s/status", wifi_get_ip());
+        ESP_LOGI(TAG, "   http://%s/history", wifi_get_ip());
+        ESP_LOGI(TAG, "   ws://%s/ws", wifi_get_ip());
     } else {
         ESP_LOGE(TAG, "❌ ERROR al iniciar servidor web: %s", esp_err_to_name(ret));
         server = NULL;
     }
 }
 
+void web_server_log_stats(void) {
+    ESP_LOGI(TAG, "/status: %lu serializaciones, %lu servidas de caché; /ws: %lu envíos a %d clientes",
+             s_status_renders, s_status_hits, s_push_count, s_ws_count);
+    if (s_httpd_task != NULL) {
+        ESP_LOGI(TAG, "Pila libre mínima de httpd: %u bytes",
+                 (unsigned)uxTaskGetStackHighWaterMark(s_httpd_task));
+    }
+    
+    web_route_t routes[WEB_ROUTE_COUNT];
+    portENTER_CRITICAL(&s_stats_mux);
+    memcpy(routes, s_routes, sizeof(routes));
+    uint32_t max_depth = s_queue_max_depth;
+    uint32_t max_wait_us = s_queue_max_wait_us;
+    uint32_t rejected = s_queue_rejected;
+    portEXIT_CRITICAL(&s_stats_mux);
+    
+    for (int i = 0; i < WEB_ROUTE_COUNT; i++) {
+        ESP_LOGI(TAG, "%-9s %s %6lu peticiones, media %6lu us, máx %7lu us", routes[i].name,
+                 routes[i].async ? "async" : "httpd", routes[i].requests, routes[i].avg_us, routes[i].max_us);
+    }
+    ESP_LOGI(TAG, "Cola de trabajadores: %u en espera, máx %lu, espera máx %lu us, %lu rechazadas (503)",
+             s_job_queue ? (unsigned)uxQueueMessagesWaiting(s_job_queue) : 0,
+             max_depth, max_wait_us, rejected);
+}
+
 void web_server_stop(void) {
     if (server) {
         httpd_stop(server);
         server = NULL;
+        s_httpd_task = NULL;
         ESP_LOGI(TAG, "Servidor web detenido");
     }
 }
@@ -308,9 +964,15 @@ system_status_t web_get_system_status(void) {
     status.button_state = button_read();
     status.press_count = button_get_press_count();
     status.ip_address = wifi_get_ip();
-    status.temperature = hardware_get_temperature();
-    status.humidity = hardware_get_humidity();
-    status.sensor_valid = hardware_sensor_valid();
+    
+    sensor_snapshot_t sensor;
+    hardware_get_sensor_snapshot(&sensor);
+    status.temperature = sensor.temperature;
+    status.humidity = sensor.humidity;
+    status.temperature_x10 = sensor.temperature_x10;
+    status.humidity_x10 = sensor.humidity_x10;
+    status.sensor_valid = sensor.valid;
+    status.sensor_seq = sensor.sample_seq;
     
     return status;
 }
\ No newline at end of file
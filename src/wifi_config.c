@@ -4,6 +4,7 @@
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "nvs_flash.h"
+#include "esp_netif_sntp.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -17,6 +18,10 @@ static const int WIFI_FAIL_BIT = BIT1;
 
 static bool s_wifi_connected = false;
 static char s_ip_address[16] = "0.0.0.0";
+static volatile uint32_t s_wifi_version = 0;
+static volatile int s_rssi = -100;
+static int s_retry_num = 0;
+static bool s_init_done = false;    // Tras el arranque se reintenta sin límite
 
 static void event_handler(void* arg, esp_event_base_t event_base, 
                                 int32_t event_id, void* event_data)
@@ -25,15 +30,27 @@ static void event_handler(void* arg, esp_event_base_t event_base,
         esp_wifi_connect();
         ESP_LOGI(TAG, "Conectando a WiFi...");
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        ESP_LOGW(TAG, "WiFi desconectado");
-        xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
         s_wifi_connected = false;
+        s_rssi = -100;
+        s_wifi_version++;
+        // Reconectar siempre: la telemetría se guarda en flash mientras tanto.
+        // Durante el arranque se limita a WIFI_MAX_RETRY intentos.
+        if (s_init_done || s_retry_num < WIFI_MAX_RETRY) {
+            s_retry_num++;
+            ESP_LOGW(TAG, "WiFi desconectado, reintentando (%d)", s_retry_num);
+            esp_wifi_connect();
+        } else {
+            ESP_LOGW(TAG, "WiFi desconectado");
+            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+        }
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         snprintf(s_ip_address, sizeof(s_ip_address), IPSTR, IP2STR(&event->ip_info.ip));
         ESP_LOGI(TAG, "✅ WiFi CONECTADO - IP: %s", s_ip_address);
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        s_retry_num = 0;
         s_wifi_connected = true;
+        s_wifi_version++;
     }
 }
 
@@ -57,7 +74,11 @@ bool wifi_init(void) {
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
-    // Registrar handlers (sin guardar las instancias para evitar reconexión)
+    // Hora real para las marcas de tiempo de la telemetría guardada offline
+    esp_sntp_config_t sntp_config = ESP_NETIF_SNTP_DEFAULT_CONFIG("pool.ntp.org");
+    esp_netif_sntp_init(&sntp_config);
+
+    // Registrar handlers (sin guardar las instancias)
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
                                                         ESP_EVENT_ANY_ID,
                                                         &event_handler,
@@ -75,12 +96,14 @@ bool wifi_init(void) {
             .ssid = WIFI_SSID,
             .password = WIFI_PASSWORD,
             .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+            .listen_interval = WIFI_LISTEN_INTERVAL,
         },
     };
     
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
+    esp_wifi_set_ps(WIFI_POWER_SAVE);
 
     ESP_LOGI(TAG, "Esperando conexión WiFi...");
 
@@ -91,8 +114,12 @@ bool wifi_init(void) {
             pdFALSE,
             pdMS_TO_TICKS(30000));
 
-    // Limpiar el event group después de la conexión inicial
-    vEventGroupDelete(s_wifi_event_group);
+    // El event group se conserva: el handler lo sigue usando al reconectar
+    s_init_done = true;
+    if (!(bits & WIFI_CONNECTED_BIT)) {
+        // Seguir intentando en segundo plano mientras el sistema arranca en modo local
+        esp_wifi_connect();
+    }
 
     if (bits & WIFI_CONNECTED_BIT) {
         ESP_LOGI(TAG, "✅ Conexión WiFi exitosa");
@@ -118,10 +145,25 @@ char* wifi_get_ip(void) {
     return s_ip_address;
 }
 
-int wifi_get_rssi(void) {
+// Consulta el RSSI al driver; llamar cada WIFI_RSSI_SAMPLE_MS. Solo un
+// cambio real de valor cuenta como cambio de versión.
+void wifi_refresh_rssi(void) {
     wifi_ap_record_t ap_info;
+    int rssi = -100;
     if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        return ap_info.rssi;
+        rssi = ap_info.rssi;
+    }
+    if (rssi != s_rssi) {
+        s_rssi = rssi;
+        s_wifi_version++;
     }
-    return -100;
+}
+
+// Último valor muestreado: no llama al driver
+int wifi_get_rssi(void) {
+    return s_rssi;
+}
+
+uint32_t wifi_get_version(void) {
+    return s_wifi_version;
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+// Generated by tools/dht11_corpus.py - do not edit
+#ifndef DHT11_CORPUS_H
+#define DHT11_CORPUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dht11_decoder.h"
+
+typedef struct
+{
+    const char *name;
+    const uint32_t *edges_us;
+    size_t edge_count;
+    dht11_decode_status_t status;
+    uint8_t raw[5];             /**< expected bytes when the frame is complete */
+} dht11_capture_t;
+
+/* Nominal timing, 45.0 % / 23.0 C */
+static const uint32_t good_nominal_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1240u, 1267u, 1317u, 1344u,
+    1394u, 1464u, 1514u, 1541u, 1591u, 1661u, 1711u, 1781u,
+    1831u, 1858u, 1908u, 1978u, 2028u, 2055u, 2105u, 2132u,
+    2182u, 2209u, 2259u, 2286u, 2336u, 2363u, 2413u, 2440u,
+    2490u, 2517u, 2567u, 2594u, 2644u, 2671u, 2721u, 2748u,
+    2798u, 2825u, 2875u, 2945u, 2995u, 3022u, 3072u, 3142u,
+    3192u, 3262u, 3312u, 3382u, 3432u, 3459u, 3509u, 3536u,
+    3586u, 3613u, 3663u, 3690u, 3740u, 3767u, 3817u, 3844u,
+    3894u, 3921u, 3971u, 3998u, 4048u, 4075u, 4125u, 4195u,
+    4245u, 4272u, 4322u, 4349u, 4399u, 4426u, 4476u, 4546u,
+    4596u, 4623u, 4673u, 4700u,
+};
+
+/* Decimal byte in use, 38.0 % / 24.6 C */
+static const uint32_t good_decimals_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1240u, 1266u, 1316u, 1342u,
+    1392u, 1464u, 1514u, 1540u, 1590u, 1616u, 1666u, 1738u,
+    1788u, 1860u, 1910u, 1936u, 1986u, 2012u, 2062u, 2088u,
+    2138u, 2164u, 2214u, 2240u, 2290u, 2316u, 2366u, 2392u,
+    2442u, 2468u, 2518u, 2544u, 2594u, 2620u, 2670u, 2696u,
+    2746u, 2772u, 2822u, 2894u, 2944u, 3016u, 3066u, 3092u,
+    3142u, 3168u, 3218u, 3244u, 3294u, 3320u, 3370u, 3396u,
+    3446u, 3472u, 3522u, 3548u, 3598u, 3624u, 3674u, 3746u,
+    3796u, 3868u, 3918u, 3944u, 3994u, 4020u, 4070u, 4142u,
+    4192u, 4218u, 4268u, 4294u, 4344u, 4370u, 4420u, 4492u,
+    4542u, 4568u, 4618u, 4644u,
+};
+
+/* +-8 us of ISR latency on every pulse */
+static const uint32_t noisy_jitter_edges[] = {
+    1000u, 1036u, 1122u, 1208u, 1266u, 1291u, 1338u, 1373u,
+    1430u, 1497u, 1542u, 1618u, 1669u, 1735u, 1779u, 1842u,
+    1896u, 1929u, 1976u, 2038u, 2096u, 2117u, 2160u, 2180u,
+    2228u, 2254u, 2296u, 2329u, 2381u, 2414u, 2462u, 2497u,
+    2546u, 2574u, 2631u, 2650u, 2694u, 2727u, 2777u, 2809u,
+    2853u, 2880u, 2932u, 3001u, 3059u, 3087u, 3129u, 3150u,
+    3195u, 3269u, 3314u, 3385u, 3439u, 3460u, 3502u, 3521u,
+    3569u, 3594u, 3637u, 3671u, 3725u, 3756u, 3811u, 3832u,
+    3880u, 3950u, 4002u, 4023u, 4074u, 4103u, 4145u, 4220u,
+    4265u, 4288u, 4337u, 4402u, 4444u, 4464u, 4520u, 4554u,
+    4601u, 4669u, 4725u, 4760u,
+};
+
+/* Sensor at the edge of its tolerances: 58 us lows, 22/78 us highs */
+static const uint32_t noisy_slow_sensor_edges[] = {
+    1000u, 1028u, 1110u, 1192u, 1247u, 1271u, 1331u, 1408u,
+    1462u, 1484u, 1542u, 1616u, 1673u, 1693u, 1753u, 1772u,
+    1826u, 1846u, 1903u, 1928u, 1986u, 2004u, 2063u, 2085u,
+    2145u, 2164u, 2219u, 2238u, 2295u, 2316u, 2370u, 2393u,
+    2452u, 2477u, 2533u, 2558u, 2614u, 2638u, 2694u, 2714u,
+    2772u, 2793u, 2850u, 2871u, 2927u, 2953u, 3010u, 3090u,
+    3151u, 3170u, 3230u, 3304u, 3359u, 3378u, 3432u, 3458u,
+    3516u, 3537u, 3597u, 3619u, 3679u, 3704u, 3762u, 3788u,
+    3844u, 3863u, 3919u, 3996u, 4057u, 4083u, 4138u, 4216u,
+    4273u, 4294u, 4348u, 4423u, 4481u, 4505u, 4566u, 4643u,
+    4697u, 4771u, 4827u, 4849u,
+};
+
+/* 32-bit esp_timer wrap in the middle of the frame */
+static const uint32_t good_timer_wrap_edges[] = {
+    4294965795u, 4294965825u, 4294965905u, 4294965985u, 4294966035u, 4294966062u, 4294966112u, 4294966139u,
+    4294966189u, 4294966259u, 4294966309u, 4294966379u, 4294966429u, 4294966456u, 4294966506u, 4294966576u,
+    4294966626u, 4294966653u, 4294966703u, 4294966730u, 4294966780u, 4294966807u, 4294966857u, 4294966884u,
+    4294966934u, 4294966961u, 4294967011u, 4294967038u, 4294967088u, 4294967115u, 4294967165u, 4294967192u,
+    4294967242u, 4294967269u, 23u, 50u, 100u, 127u, 177u, 204u,
+    254u, 281u, 331u, 401u, 451u, 521u, 571u, 641u,
+    691u, 761u, 811u, 881u, 931u, 958u, 1008u, 1035u,
+    1085u, 1112u, 1162u, 1189u, 1239u, 1266u, 1316u, 1343u,
+    1393u, 1420u, 1470u, 1497u, 1547u, 1574u, 1624u, 1694u,
+    1744u, 1771u, 1821u, 1891u, 1941u, 1968u, 2018u, 2045u,
+    2095u, 2165u, 2215u, 2285u,
+};
+
+/* Capture timed out after 60 edges */
+static const uint32_t truncated_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1240u, 1267u, 1317u, 1344u,
+    1394u, 1464u, 1514u, 1541u, 1591u, 1661u, 1711u, 1738u,
+    1788u, 1815u, 1865u, 1892u, 1942u, 1969u, 2019u, 2046u,
+    2096u, 2123u, 2173u, 2200u, 2250u, 2277u, 2327u, 2354u,
+    2404u, 2431u, 2481u, 2508u, 2558u, 2585u, 2635u, 2662u,
+    2712u, 2739u, 2789u, 2859u, 2909u, 2936u, 2986u, 3056u,
+    3106u, 3176u, 3226u, 3253u, 3303u, 3330u, 3380u, 3407u,
+    3457u, 3484u, 3534u, 3561u,
+};
+
+/* One edge missed: the merged pulse still fits, the bits shift */
+static const uint32_t lost_edge_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1240u, 1267u, 1317u, 1344u,
+    1394u, 1464u, 1514u, 1541u, 1591u, 1661u, 1711u, 1738u,
+    1788u, 1815u, 1865u, 1892u, 1942u, 1969u, 2019u, 2046u,
+    2096u, 2123u, 2173u, 2200u, 2250u, 2277u, 2327u, 2354u,
+    2404u, 2431u, 2481u, 2508u, 2558u, 2585u, 2635u, 2662u,
+    2739u, 2789u, 2859u, 2909u, 2936u, 2986u, 3056u, 3106u,
+    3176u, 3226u, 3253u, 3303u, 3330u, 3380u, 3407u, 3457u,
+    3484u, 3534u, 3561u, 3611u, 3638u, 3688u, 3715u, 3765u,
+    3792u, 3842u, 3869u, 3919u, 3946u, 3996u, 4023u, 4073u,
+    4143u, 4193u, 4263u, 4313u, 4383u, 4433u, 4503u, 4553u,
+    4623u, 4673u, 4700u, 4750u,
+};
+
+/* Slow sensor and one edge missed: a 58 + 78 us pulse */
+static const uint32_t lost_edge_slow_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1248u, 1270u, 1328u, 1350u,
+    1408u, 1486u, 1544u, 1566u, 1624u, 1702u, 1760u, 1782u,
+    1840u, 1862u, 1920u, 1942u, 2000u, 2022u, 2080u, 2102u,
+    2160u, 2182u, 2240u, 2262u, 2320u, 2342u, 2400u, 2422u,
+    2480u, 2502u, 2560u, 2582u, 2640u, 2662u, 2720u, 2742u,
+    2800u, 2822u, 2958u, 3016u, 3038u, 3096u, 3174u, 3232u,
+    3310u, 3368u, 3390u, 3448u, 3470u, 3528u, 3550u, 3608u,
+    3630u, 3688u, 3710u, 3768u, 3790u, 3848u, 3870u, 3928u,
+    3950u, 4008u, 4030u, 4088u, 4110u, 4168u, 4190u, 4248u,
+    4326u, 4384u, 4462u, 4520u, 4598u, 4656u, 4734u, 4792u,
+    4870u, 4928u, 4950u, 5008u,
+};
+
+/* 2 us spike inside a high pulse shifts the bit alignment */
+static const uint32_t glitch_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1240u, 1267u, 1317u, 1344u,
+    1394u, 1464u, 1514u, 1541u, 1591u, 1661u, 1711u, 1738u,
+    1788u, 1815u, 1865u, 1892u, 1942u, 1952u, 1954u, 1969u,
+    2019u, 2046u, 2096u, 2123u, 2173u, 2200u, 2250u, 2277u,
+    2327u, 2354u, 2404u, 2431u, 2481u, 2508u, 2558u, 2585u,
+    2635u, 2662u, 2712u, 2739u, 2789u, 2859u, 2909u, 2936u,
+    2986u, 3056u, 3106u, 3176u, 3226u, 3253u, 3303u, 3330u,
+    3380u, 3407u, 3457u, 3484u, 3534u, 3561u, 3611u, 3638u,
+    3688u, 3715u, 3765u, 3792u, 3842u, 3869u, 3919u, 3946u,
+    3996u, 4023u, 4073u, 4143u, 4193u, 4263u, 4313u, 4383u,
+    4433u, 4503u, 4553u, 4623u,
+};
+
+/* Last checksum bit flipped on the wire */
+static const uint32_t bad_checksum_edges[] = {
+    1000u, 1030u, 1110u, 1190u, 1240u, 1267u, 1317u, 1344u,
+    1394u, 1464u, 1514u, 1541u, 1591u, 1661u, 1711u, 1738u,
+    1788u, 1815u, 1865u, 1892u, 1942u, 1969u, 2019u, 2046u,
+    2096u, 2123u, 2173u, 2200u, 2250u, 2277u, 2327u, 2354u,
+    2404u, 2431u, 2481u, 2508u, 2558u, 2585u, 2635u, 2662u,
+    2712u, 2739u, 2789u, 2859u, 2909u, 2936u, 2986u, 3056u,
+    3106u, 3176u, 3226u, 3253u, 3303u, 3330u, 3380u, 3407u,
+    3457u, 3484u, 3534u, 3561u, 3611u, 3638u, 3688u, 3715u,
+    3765u, 3792u, 3842u, 3869u, 3919u, 3946u, 3996u, 4023u,
+    4073u, 4143u, 4193u, 4263u, 4313u, 4383u, 4433u, 4503u,
+    4553u, 4623u, 4673u, 4743u,
+};
+
+static const dht11_capture_t dht11_corpus[] = {
+    { "good_nominal", good_nominal_edges, 84, DHT11_DECODE_OK, { 45, 0, 23, 0, 68 } },
+    { "good_decimals", good_decimals_edges, 84, DHT11_DECODE_OK, { 38, 0, 24, 6, 68 } },
+    { "noisy_jitter", noisy_jitter_edges, 84, DHT11_DECODE_OK, { 61, 0, 19, 2, 82 } },
+    { "noisy_slow_sensor", noisy_slow_sensor_edges, 84, DHT11_DECODE_OK, { 80, 0, 5, 1, 86 } },
+    { "good_timer_wrap", good_timer_wrap_edges, 84, DHT11_DECODE_OK, { 52, 0, 31, 0, 83 } },
+    { "truncated", truncated_edges, 60, DHT11_DECODE_TRUNCATED, { 0, 0, 0, 0, 0 } },
+    { "lost_edge", lost_edge_edges, 84, DHT11_DECODE_CHECKSUM, { 40, 0, 9, 255, 193 } },
+    { "lost_edge_slow", lost_edge_slow_edges, 84, DHT11_DECODE_BAD_PULSE, { 0, 0, 0, 0, 0 } },
+    { "glitch", glitch_edges, 84, DHT11_DECODE_CHECKSUM, { 40, 64, 11, 0, 31 } },
+    { "bad_checksum", bad_checksum_edges, 84, DHT11_DECODE_CHECKSUM, { 40, 0, 22, 0, 63 } },
+};
+
+#endif
\ No newline at end of file
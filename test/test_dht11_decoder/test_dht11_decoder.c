@@ -0,0 +1,124 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "dht11_decoder.h"
+#include "dht11_corpus.h"
+
+#define CORPUS_COUNT (sizeof(dht11_corpus) / sizeof(dht11_corpus[0]))
+/** Frames decoded by the benchmark; enough to dwarf the clock() resolution */
+#define BENCH_FRAMES 200000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static dht11_decode_status_t decode_capture(const dht11_capture_t *capture,dht11_frame_t *frame)
+{
+    uint16_t pulses_us[DHT11_FRAME_PULSES];
+    size_t count = dht11_edges_to_pulses(capture->edges_us, capture->edge_count, pulses_us);
+    return dht11_decode_pulses(pulses_us, count, frame);
+}
+
+static const dht11_capture_t *find_capture(const char *name)
+{
+    for(size_t i = 0; i < CORPUS_COUNT; i++)
+    {
+        if(strcmp(dht11_corpus[i].name, name) == 0) return &dht11_corpus[i];
+    }
+    TEST_FAIL_MESSAGE(name);
+    return NULL;
+}
+
+/** Every recorded capture decodes to the status and bytes stored with it */
+static void test_corpus(void)
+{
+    for(size_t i = 0; i < CORPUS_COUNT; i++)
+    {
+        const dht11_capture_t *capture = &dht11_corpus[i];
+        dht11_frame_t frame;
+        dht11_decode_status_t status = decode_capture(capture, &frame);
+
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(dht11_decode_status_name(capture->status),
+                                         dht11_decode_status_name(status), capture->name);
+        if(status == DHT11_DECODE_OK || status == DHT11_DECODE_CHECKSUM)
+        {
+            TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(capture->raw, frame.raw, 5, capture->name);
+        }
+    }
+}
+
+static void test_values_in_tenths(void)
+{
+    dht11_frame_t frame;
+    TEST_ASSERT_EQUAL(DHT11_DECODE_OK, decode_capture(find_capture("good_decimals"), &frame));
+    TEST_ASSERT_EQUAL_INT(380, frame.humidity_x10);
+    TEST_ASSERT_EQUAL_INT(246, frame.temperature_x10);
+}
+
+/** esp_timer is truncated to 32 bits: a frame across the wrap still has sane widths */
+static void test_timer_wrap(void)
+{
+    const dht11_capture_t *capture = find_capture("good_timer_wrap");
+    TEST_ASSERT_TRUE(capture->edges_us[capture->edge_count - 1] < capture->edges_us[0]);
+
+    uint16_t pulses_us[DHT11_FRAME_PULSES];
+    size_t count = dht11_edges_to_pulses(capture->edges_us, capture->edge_count, pulses_us);
+    TEST_ASSERT_EQUAL_size_t(DHT11_FRAME_PULSES, count);
+    for(size_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_TRUE(pulses_us[i] <= DHT11_PULSE_MAX_US);
+    }
+}
+
+/** A timed out capture only yields the pulses between the edges it got */
+static void test_truncated_pulse_count(void)
+{
+    const dht11_capture_t *capture = find_capture("truncated");
+    uint16_t pulses_us[DHT11_FRAME_PULSES];
+    size_t count = dht11_edges_to_pulses(capture->edges_us, capture->edge_count, pulses_us);
+    TEST_ASSERT_EQUAL_size_t(capture->edge_count - DHT11_FIRST_DATA_EDGE - 1, count);
+
+    TEST_ASSERT_EQUAL_size_t(0, dht11_edges_to_pulses(capture->edges_us, DHT11_FIRST_DATA_EDGE, pulses_us));
+}
+
+/** A gap longer than 65535us saturates instead of wrapping into a valid width */
+static void test_long_gap_saturates(void)
+{
+    uint32_t edges_us[DHT11_FIRST_DATA_EDGE + 2] = { 0, 30, 110, 190, 190 + 65536 + 50 };
+    uint16_t pulses_us[DHT11_FRAME_PULSES];
+    TEST_ASSERT_EQUAL_size_t(1, dht11_edges_to_pulses(edges_us, DHT11_FIRST_DATA_EDGE + 2, pulses_us));
+    TEST_ASSERT_EQUAL_UINT(UINT16_MAX, pulses_us[0]);
+}
+
+/** Decode cost of a full capture (edges to pulses and frame), host time */
+static void test_benchmark(void)
+{
+    const dht11_capture_t *capture = find_capture("noisy_jitter");
+    dht11_frame_t frame;
+    volatile int ok = 0;
+
+    clock_t start = clock();
+    for(int i = 0; i < BENCH_FRAMES; i++)
+    {
+        ok += decode_capture(capture, &frame) == DHT11_DECODE_OK;
+    }
+    double elapsed_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+    TEST_ASSERT_EQUAL_INT(BENCH_FRAMES, ok);
+
+    char message[80];
+    snprintf(message, sizeof(message), "%.1f ns per capture (%d captures)",
+             elapsed_s * 1e9 / BENCH_FRAMES, BENCH_FRAMES);
+    TEST_MESSAGE(message);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus);
+    RUN_TEST(test_values_in_tenths);
+    RUN_TEST(test_timer_wrap);
+    RUN_TEST(test_truncated_pulse_count);
+    RUN_TEST(test_long_gap_saturates);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
\ No newline at end of file
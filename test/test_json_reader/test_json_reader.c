@@ -0,0 +1,327 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "json_reader.h"
+
+// Cada token se apunta como "tipo profundidad texto|" para comparar lecturas
+#define TRACE_MAX 2048
+
+typedef struct {
+    char text[TRACE_MAX];
+    size_t len;
+    int abort_at;           // Aborta al llegar a este token (-1 = nunca)
+    int tokens;
+} trace_t;
+
+typedef struct {
+    json_reader_error_t error;
+    size_t offset;
+    char trace[TRACE_MAX];
+} read_result_t;
+
+static const char *const TOKEN_NAMES[] = {
+    "{", "}", "[", "]", "K", "S", "N", "T", "F", "Z",
+};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static bool trace_token(void *ctx, const json_token_t *tok)
+{
+    trace_t *t = ctx;
+    if (t->tokens++ == t->abort_at) {
+        return false;
+    }
+    int n = snprintf(t->text + t->len, sizeof(t->text) - t->len, "%s%u%s|",
+                     TOKEN_NAMES[tok->type], tok->depth, tok->text);
+    TEST_ASSERT_TRUE(n > 0 && (size_t)n < sizeof(t->text) - t->len);
+    t->len += (size_t)n;
+    return true;
+}
+
+// Lee doc entregándolo en trozos de como mucho chunk bytes, empezando por
+// uno de first bytes (0 = todo en un trozo)
+static void read_split(const char *doc, size_t len, size_t first, size_t chunk,
+                       int abort_at, read_result_t *out)
+{
+    trace_t t = { .abort_at = abort_at };
+    json_reader_t r;
+    json_reader_init(&r, trace_token, &t);
+
+    size_t pos = 0;
+    bool ok = true;
+    if (first > 0 && first < len) {
+        ok = json_reader_feed(&r, doc, first);
+        pos = first;
+    }
+    while (ok && pos < len) {
+        size_t n = (chunk == 0 || len - pos < chunk) ? len - pos : chunk;
+        ok = json_reader_feed(&r, doc + pos, n);
+        pos += n;
+    }
+    if (ok) {
+        json_reader_finish(&r);
+    }
+
+    out->error = r.error;
+    out->offset = r.offset;
+    memcpy(out->trace, t.text, t.len + 1);
+}
+
+// El resultado no puede depender de dónde se corte el documento: se compara
+// la lectura de un trozo con todos los cortes en dos y con byte a byte
+static void check_doc(const char *doc, json_reader_error_t error, const char *trace)
+{
+    size_t len = strlen(doc);
+    read_result_t whole;
+    read_split(doc, len, 0, 0, -1, &whole);
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(json_reader_error_str(error),
+                                     json_reader_error_str(whole.error), doc);
+    if (trace != NULL) {
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(trace, whole.trace, doc);
+    }
+
+    char message[128];
+    for (size_t cut = 1; cut < len; cut++) {
+        read_result_t split;
+        read_split(doc, len, cut, 0, -1, &split);
+        snprintf(message, sizeof(message), "%s (corte en %u)", doc, (unsigned)cut);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(whole.error, split.error, message);
+        TEST_ASSERT_EQUAL_UINT_MESSAGE(whole.offset, split.offset, message);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(whole.trace, split.trace, message);
+    }
+
+    read_result_t bytes;
+    read_split(doc, len, 0, 1, -1, &bytes);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(whole.error, bytes.error, doc);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(whole.offset, bytes.offset, doc);
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(whole.trace, bytes.trace, doc);
+}
+
+static void check_error_at(const char *doc, json_reader_error_t error, size_t offset)
+{
+    read_result_t res;
+    read_split(doc, strlen(doc), 0, 0, -1, &res);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(offset, res.offset, doc);
+    check_doc(doc, error, NULL);
+}
+
+static void test_led_requests(void)
+{
+    check_doc("{\"action\":\"toggle\"}", JSON_READER_OK,
+              "{0|K1action|S1toggle|}0|");
+    check_doc("{\"action\":1}", JSON_READER_OK, "{0|K1action|N11|}0|");
+    check_doc(" {\n\t\"actions\" : [ {\"action\":\"on\",\"delay_ms\":0}, 2 , {\"action\":0,\"delay_ms\":1500} ]\r\n} ",
+              JSON_READER_OK,
+              "{0|K1actions|[1|{2|K3action|S3on|K3delay_ms|N30|}2|N22|"
+              "{2|K3action|N30|K3delay_ms|N31500|}2|]1|}0|");
+}
+
+static void test_values(void)
+{
+    check_doc("[true,false,null,\"\",-0,12.5,1e3,-2.25E-2,{},[]]", JSON_READER_OK,
+              "[0|T1|F1|Z1|S1|N1-0|N112.5|N11e3|N1-2.25E-2|{1|}1|[1|]1|]0|");
+    check_doc("42", JSON_READER_OK, "N042|");
+    check_doc("\"solo\"", JSON_READER_OK, "S0solo|");
+    check_doc("null", JSON_READER_OK, "Z0|");
+}
+
+static void test_escapes(void)
+{
+    check_doc("[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"]", JSON_READER_OK, "[0|S1\"\\/\b\f\n\r\t|]0|");
+    check_doc("{\"\\u0041\\u00e9\\u20AC\":\"a\\u0000b\"}", JSON_READER_OK,
+              "{0|K1A\xC3\xA9\xE2\x82\xAC|S1a|}0|");
+    check_error_at("[\"\\x\"]", JSON_READER_SYNTAX, 3);
+    check_error_at("[\"\\u12G4\"]", JSON_READER_SYNTAX, 6);
+    check_error_at("[\"a\nb\"]", JSON_READER_SYNTAX, 3);
+}
+
+static bool expect_nul_string(void *ctx, const json_token_t *tok)
+{
+    (void)ctx;
+    TEST_ASSERT_EQUAL_INT(JSON_TOK_STRING, tok->type);
+    TEST_ASSERT_EQUAL_size_t(3, tok->len);
+    TEST_ASSERT_EQUAL_MEMORY("a\0b", tok->text, 3);
+    return true;
+}
+
+static void test_escapes_keep_token_text(void)
+{
+    // \u0000 corta el texto en C pero len conserva los bytes leídos
+    json_reader_t r;
+    json_reader_init(&r, expect_nul_string, NULL);
+    TEST_ASSERT_TRUE(json_reader_feed(&r, "\"a\\u0000b\"", 10));
+    TEST_ASSERT_TRUE(json_reader_finish(&r));
+}
+
+static void test_depth_limit(void)
+{
+    char doc[2 * JSON_READER_MAX_DEPTH + 3];
+    memset(doc, '[', JSON_READER_MAX_DEPTH);
+    memset(doc + JSON_READER_MAX_DEPTH, ']', JSON_READER_MAX_DEPTH);
+    doc[2 * JSON_READER_MAX_DEPTH] = '\0';
+    check_doc(doc, JSON_READER_OK, NULL);
+
+    memset(doc, '[', JSON_READER_MAX_DEPTH + 1);
+    memset(doc + JSON_READER_MAX_DEPTH + 1, ']', JSON_READER_MAX_DEPTH + 1);
+    doc[2 * JSON_READER_MAX_DEPTH + 2] = '\0';
+    check_error_at(doc, JSON_READER_TOO_DEEP, JSON_READER_MAX_DEPTH);
+
+    // Objetos y arrays cuentan igual
+    check_error_at("{\"a\":[{\"b\":[{\"c\":[{\"d\":[{\"e\":[{\"f\":[{\"g\":[{\"h\":[{}]}]}]}]}]}]}]}]}",
+                   JSON_READER_TOO_DEEP, 48);
+}
+
+static void test_length_limit(void)
+{
+    char doc[JSON_READER_MAX_TOKEN + 8];
+    char trace[JSON_READER_MAX_TOKEN + 8];
+
+    // Cadena justo del tamaño máximo y una más
+    doc[0] = '"';
+    memset(doc + 1, 'x', JSON_READER_MAX_TOKEN);
+    strcpy(doc + 1 + JSON_READER_MAX_TOKEN, "\"");
+    snprintf(trace, sizeof(trace), "S0%.*s|", JSON_READER_MAX_TOKEN, doc + 1);
+    check_doc(doc, JSON_READER_OK, trace);
+
+    memset(doc + 1, 'x', JSON_READER_MAX_TOKEN + 1);
+    strcpy(doc + 2 + JSON_READER_MAX_TOKEN, "\"");
+    check_error_at(doc, JSON_READER_TOO_LONG, JSON_READER_MAX_TOKEN + 1);
+
+    // Números y claves tienen el mismo límite
+    memset(doc, '7', JSON_READER_MAX_TOKEN);
+    doc[JSON_READER_MAX_TOKEN] = '\0';
+    check_doc(doc, JSON_READER_OK, NULL);
+    memset(doc, '7', JSON_READER_MAX_TOKEN + 1);
+    doc[JSON_READER_MAX_TOKEN + 1] = '\0';
+    check_error_at(doc, JSON_READER_TOO_LONG, JSON_READER_MAX_TOKEN);
+
+    char key[JSON_READER_MAX_TOKEN + 16];
+    snprintf(key, sizeof(key), "{\"%0*d\":1}", JSON_READER_MAX_TOKEN + 1, 0);
+    check_error_at(key, JSON_READER_TOO_LONG, JSON_READER_MAX_TOKEN + 2);
+
+    // El límite es en bytes ya decodificados: \u20AC ocupa 3
+    check_doc("\"\\u20AC\\u20AC\\u20AC\\u20AC\\u20AC\\u20AC\\u20AC\\u20ACxxxxxxxx\"",
+              JSON_READER_OK, NULL);
+    check_error_at("\"\\u20AC\\u20AC\\u20AC\\u20AC\\u20AC\\u20AC\\u20AC\\u20ACxxxxxxxx\\u20AC\"",
+                   JSON_READER_TOO_LONG, 62);
+}
+
+static void test_syntax_errors(void)
+{
+    check_error_at("[1,]", JSON_READER_SYNTAX, 3);
+    check_error_at("[1 2]", JSON_READER_SYNTAX, 3);
+    check_error_at("{\"a\" 1}", JSON_READER_SYNTAX, 5);
+    check_error_at("{1:2}", JSON_READER_SYNTAX, 1);
+    check_error_at("{\"a\":1,}", JSON_READER_SYNTAX, 7);
+    check_error_at("{\"a\":1]", JSON_READER_SYNTAX, 6);
+    check_error_at("[}", JSON_READER_SYNTAX, 1);
+    check_error_at("]", JSON_READER_SYNTAX, 0);
+    check_error_at("[01]", JSON_READER_SYNTAX, 3);
+    check_error_at("[1.]", JSON_READER_SYNTAX, 3);
+    check_error_at("[-]", JSON_READER_SYNTAX, 2);
+    check_error_at("[1e+]", JSON_READER_SYNTAX, 4);
+    check_error_at("[trye]", JSON_READER_SYNTAX, 3);
+    check_error_at("{} {}", JSON_READER_SYNTAX, 3);
+    check_error_at("1 2", JSON_READER_SYNTAX, 2);
+}
+
+static void test_incomplete(void)
+{
+    check_doc("", JSON_READER_INCOMPLETE, "");
+    check_doc("   ", JSON_READER_INCOMPLETE, "");
+    check_doc("{\"action\":", JSON_READER_INCOMPLETE, "{0|K1action|");
+    check_doc("[1", JSON_READER_INCOMPLETE, "[0|N11|");
+    check_doc("\"abc", JSON_READER_INCOMPLETE, "");
+    check_doc("\"abc\\", JSON_READER_INCOMPLETE, "");
+    check_doc("\"\\u20", JSON_READER_INCOMPLETE, "");
+    check_doc("tru", JSON_READER_INCOMPLETE, "");
+    // Un número al final solo se cierra en finish()
+    check_doc("-", JSON_READER_SYNTAX, "");
+}
+
+static void test_abort_and_sticky_error(void)
+{
+    const char *doc = "{\"action\":\"on\"}";
+    read_result_t res;
+    read_split(doc, strlen(doc), 0, 0, 2, &res);
+    TEST_ASSERT_EQUAL_INT(JSON_READER_ABORTED, res.error);
+    TEST_ASSERT_EQUAL_UINT(13, res.offset);
+    TEST_ASSERT_EQUAL_STRING("{0|K1action|", res.trace);
+
+    // Tras un error no se procesa nada más
+    trace_t t = { .abort_at = -1 };
+    json_reader_t r;
+    json_reader_init(&r, trace_token, &t);
+    TEST_ASSERT_FALSE(json_reader_feed(&r, "[}", 2));
+    TEST_ASSERT_FALSE(json_reader_feed(&r, "]", 1));
+    TEST_ASSERT_FALSE(json_reader_finish(&r));
+    TEST_ASSERT_EQUAL_INT(JSON_READER_SYNTAX, r.error);
+    TEST_ASSERT_EQUAL_STRING("[0|", t.text);
+}
+
+static void check_int(const char *text, bool ok, int32_t expected)
+{
+    json_token_t tok = { .type = JSON_TOK_NUMBER, .text = text, .len = strlen(text) };
+    int32_t value = 12345;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(ok, json_token_to_int(&tok, &value), text);
+    TEST_ASSERT_EQUAL_INT32(ok ? expected : 12345, value);
+}
+
+static void test_token_to_int(void)
+{
+    check_int("0", true, 0);
+    check_int("-0", true, 0);
+    check_int("1500", true, 1500);
+    check_int("2147483647", true, INT32_MAX);
+    check_int("-2147483648", true, INT32_MIN);
+    check_int("2147483648", false, 0);
+    check_int("-2147483649", false, 0);
+    check_int("99999999999999999999", false, 0);
+    check_int("1.0", false, 0);
+    check_int("1e3", false, 0);
+
+    json_token_t tok = { .type = JSON_TOK_STRING, .text = "1", .len = 1 };
+    int32_t value;
+    TEST_ASSERT_FALSE(json_token_to_int(&tok, &value));
+}
+
+static void test_led_action(void)
+{
+    json_token_t tok = { .type = JSON_TOK_STRING, .text = "toggle", .len = 6 };
+    TEST_ASSERT_EQUAL_INT(2, led_action_from_token(&tok));
+    tok.text = "1";             // Como cadena solo valen los nombres
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_token(&tok));
+    tok.type = JSON_TOK_NUMBER;
+    TEST_ASSERT_EQUAL_INT(1, led_action_from_token(&tok));
+    tok.text = "3";
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_token(&tok));
+    tok.text = "1.0";
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_token(&tok));
+    tok.type = JSON_TOK_TRUE;
+    tok.text = "";
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_token(&tok));
+
+    TEST_ASSERT_EQUAL_INT(0, led_action_from_text("off"));
+    TEST_ASSERT_EQUAL_INT(2, led_action_from_text("2"));
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_text("20"));
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_text("ON"));
+    TEST_ASSERT_EQUAL_INT(-1, led_action_from_text(""));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_led_requests);
+    RUN_TEST(test_values);
+    RUN_TEST(test_escapes);
+    RUN_TEST(test_escapes_keep_token_text);
+    RUN_TEST(test_depth_limit);
+    RUN_TEST(test_length_limit);
+    RUN_TEST(test_syntax_errors);
+    RUN_TEST(test_incomplete);
+    RUN_TEST(test_abort_and_sticky_error);
+    RUN_TEST(test_token_to_int);
+    RUN_TEST(test_led_action);
+    return UNITY_END();
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "json_writer.h"
+
+// Serializaciones por medida; bastan para que la resolución de clock() no cuente
+#define BENCH_ITERATIONS 200000
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// El documento de /status tal como se armaba antes con snprintf y %.1f
+static size_t status_printf(char *buf, size_t size, int16_t temperature_x10, uint16_t humidity_x10)
+{
+    volatile float temperature = temperature_x10 / 10.0f;
+    volatile float humidity = humidity_x10 / 10.0f;
+    return snprintf(buf, size,
+                    "{\"led_state\":%s,\"button_state\":%s,\"press_count\":%lu,\"ip_address\":\"%s\",\"rssi\":%d,\"temperature\":%.1f,\"humidity\":%.1f,\"sensor_valid\":%s}",
+                    "true", "false", (unsigned long)1234, "192.168.1.50", -61,
+                    temperature, humidity, "true");
+}
+
+// El mismo documento con json_writer y los valores en décimas
+static size_t status_writer(char *buf, size_t size, int16_t temperature_x10, uint16_t humidity_x10)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_obj_begin(&w);
+    json_kv_bool(&w, "led_state", true);
+    json_kv_bool(&w, "button_state", false);
+    json_kv_uint(&w, "press_count", 1234);
+    json_kv_str(&w, "ip_address", "192.168.1.50");
+    json_kv_int(&w, "rssi", -61);
+    json_kv_fixed(&w, "temperature", temperature_x10, 1);
+    json_kv_fixed(&w, "humidity", humidity_x10, 1);
+    json_kv_bool(&w, "sensor_valid", true);
+    json_obj_end(&w);
+    return json_writer_finish(&w);
+}
+
+// Salida idéntica byte a byte en todo el rango del DHT11 y algo más
+static void test_status_matches_printf(void)
+{
+    char expected[256];
+    char actual[256];
+    for (int t = -400; t <= 800; t++) {
+        uint16_t h = (uint16_t)((t + 400) % 1001);
+        size_t len = status_printf(expected, sizeof(expected), t, h);
+        TEST_ASSERT_EQUAL_size_t(len, status_writer(actual, sizeof(actual), t, h));
+        TEST_ASSERT_EQUAL_STRING(expected, actual);
+    }
+}
+
+static void check_fixed(int32_t value, uint8_t decimals, const char *expected)
+{
+    char buf[32];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    json_put_fixed(&w, value, decimals);
+    TEST_ASSERT_TRUE(json_writer_finish(&w) > 0);
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+}
+
+static void test_numbers(void)
+{
+    check_fixed(235, 1, "23.5");
+    check_fixed(-5, 1, "-0.5");
+    check_fixed(0, 1, "0.0");
+    check_fixed(7, 3, "0.007");
+    check_fixed(-1200, 2, "-12.00");
+    check_fixed(42, 0, "42");
+    check_fixed(INT32_MIN, 1, "-214748364.8");
+
+    char buf[96];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    json_arr_begin(&w);
+    json_put_int(&w, INT32_MIN);
+    json_put_uint(&w, UINT32_MAX);
+    json_put_int64(&w, INT64_MIN);
+    json_put_null(&w);
+    json_arr_end(&w);
+    TEST_ASSERT_TRUE(json_writer_finish(&w) > 0);
+    TEST_ASSERT_EQUAL_STRING("[-2147483648,4294967295,-9223372036854775808,null]", buf);
+}
+
+static void test_escapes(void)
+{
+    char buf[64];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    json_obj_begin(&w);
+    json_kv_str(&w, "a\"b", "c\\d\n\r\t\x01\xC3\xA9");
+    json_obj_end(&w);
+    TEST_ASSERT_TRUE(json_writer_finish(&w) > 0);
+    TEST_ASSERT_EQUAL_STRING("{\"a\\\"b\":\"c\\\\d\\n\\r\\t\\u0001\xC3\xA9\"}", buf);
+}
+
+// Si no cabe todo el documento se devuelve 0 y una cadena vacía
+static void test_overflow(void)
+{
+    char buf[256];
+    size_t len = status_writer(buf, sizeof(buf), 235, 610);
+    TEST_ASSERT_TRUE(len > 0);
+
+    // Hace falta sitio para el '\0'
+    TEST_ASSERT_EQUAL_size_t(0, status_writer(buf, len, 235, 610));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+    TEST_ASSERT_EQUAL_size_t(len, status_writer(buf, len + 1, 235, 610));
+
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    json_obj_begin(&w);
+    TEST_ASSERT_EQUAL_size_t(0, json_writer_finish(&w));
+}
+
+// Por trozos: reset_buffer vacía el buffer sin perder comas ni anidamiento
+static void test_reset_buffer(void)
+{
+    char out[64] = "";
+    char buf[16];
+    json_writer_t w;
+    json_writer_init(&w, buf, sizeof(buf));
+    json_arr_begin(&w);
+    for (int i = 0; i < 5; i++) {
+        json_put_int(&w, i * 100);
+        strncat(out, buf, w.len);
+        json_writer_reset_buffer(&w);
+    }
+    json_arr_end(&w);
+    TEST_ASSERT_TRUE(json_writer_finish(&w) > 0);
+    strcat(out, buf);
+    TEST_ASSERT_EQUAL_STRING("[0,100,200,300,400]", out);
+}
+
+// Tiempo por serialización del documento de /status en el PC. En el C3
+// (sin FPU, %.1f por software) la diferencia es mayor: para medirla allí
+// está json_writer_benchmark() con -DJSON_WRITER_BENCHMARK.
+static void test_benchmark(void)
+{
+    char buf[256];
+    volatile int16_t temperature_x10 = 235;
+    volatile uint16_t humidity_x10 = 610;
+    volatile size_t len = 0;
+
+    clock_t start = clock();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        len += status_printf(buf, sizeof(buf), temperature_x10, humidity_x10);
+    }
+    double printf_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / BENCH_ITERATIONS;
+
+    start = clock();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        len += status_writer(buf, sizeof(buf), temperature_x10, humidity_x10);
+    }
+    double writer_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / BENCH_ITERATIONS;
+    TEST_ASSERT_TRUE(len > 0);
+
+    char message[96];
+    snprintf(message, sizeof(message), "snprintf %%.1f: %.0f ns, json_writer: %.0f ns por serialización",
+             printf_ns, writer_ns);
+    TEST_MESSAGE(message);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_status_matches_printf);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_escapes);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_reset_buffer);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
\ No newline at end of file
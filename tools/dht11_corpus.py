@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Generate the DHT11 edge-capture corpus used by the native decoder tests.
+
+Each capture has the layout produced by dht11_read_isr(): one esp_timer
+timestamp (us, truncated to 32 bits) per edge, starting with the host
+releasing the line. Widths follow the DHT11 datasheet (80/80 us response,
+50 us low per bit, 26-28 us high for 0 and 70 us for 1) and the noisy
+captures add the ISR latency jitter that delays each edge timestamp.
+A fixed seed keeps the output stable.
+
+Usage:
+    dht11_corpus.py test/test_dht11_decoder/dht11_corpus.h
+"""
+
+import argparse
+import random
+
+FRAME_BITS = 40
+FIRST_DATA_EDGE = 3
+# dht11_read_isr() stops at the falling edge that ends the last bit
+DATA_EDGES = FIRST_DATA_EDGE + FRAME_BITS * 2 + 1
+PULSE_MAX_US = 120
+
+
+def frame_bytes(hum, hum_dec, temp, temp_dec):
+    data = [hum, hum_dec, temp, temp_dec]
+    return data + [sum(data) & 0xFF]
+
+
+def edges_for(raw, start=1000, low=50, zero=27, one=70, jitter=0, rng=None):
+    """Edge timestamps for a full transmission of the five bytes in raw,
+    including the final release of the line after the closing 50 us low."""
+    def j():
+        return rng.randint(-jitter, jitter) if jitter else 0
+
+    t = start
+    edges = [t]                 # host releases the line
+    t += 30 + j()
+    edges.append(t)             # sensor pulls low
+    t += 80 + j()
+    edges.append(t)             # sensor releases
+    t += 80 + j()
+    edges.append(t)             # first bit low starts
+    for bit in range(FRAME_BITS):
+        value = (raw[bit // 8] >> (7 - bit % 8)) & 1
+        t += low + j()
+        edges.append(t)
+        t += (one if value else zero) + j()
+        edges.append(t)
+    t += low + j()
+    edges.append(t)             # sensor releases the line
+    return [e & 0xFFFFFFFF for e in edges]
+
+
+def capture(edges):
+    """What the ISR keeps: edges up to DATA_EDGES."""
+    return edges[:DATA_EDGES]
+
+
+def decode(edges):
+    """Python model of dht11_edges_to_pulses() + dht11_decode_pulses()."""
+    pulses = [(edges[i + 1] - edges[i]) & 0xFFFFFFFF
+              for i in range(FIRST_DATA_EDGE, len(edges) - 1)][:FRAME_BITS * 2]
+    if len(pulses) < FRAME_BITS * 2:
+        return "DHT11_DECODE_TRUNCATED", None
+    raw = [0] * 5
+    for bit in range(FRAME_BITS):
+        low, high = pulses[2 * bit], pulses[2 * bit + 1]
+        if low > PULSE_MAX_US or high > PULSE_MAX_US:
+            return "DHT11_DECODE_BAD_PULSE", None
+        raw[bit // 8] |= (high > low) << (7 - bit % 8)
+    if sum(raw[:4]) & 0xFF != raw[4]:
+        return "DHT11_DECODE_CHECKSUM", raw
+    return "DHT11_DECODE_OK", raw
+
+
+def build():
+    rng = random.Random(11)
+    captures = []
+
+    def add(name, comment, edges, status, raw=None):
+        edges = capture(edges)
+        got, got_raw = decode(edges)
+        assert got == status, (name, got)
+        if raw is not None:
+            assert got_raw == raw, (name, got_raw)
+        # On a checksum error the bytes are whatever the model read
+        captures.append((name, comment, edges, status, got_raw))
+
+    raw = frame_bytes(45, 0, 23, 0)
+    add("good_nominal", "Nominal timing, 45.0 % / 23.0 C", edges_for(raw), "DHT11_DECODE_OK", raw)
+
+    raw = frame_bytes(38, 0, 24, 6)
+    add("good_decimals", "Decimal byte in use, 38.0 % / 24.6 C",
+        edges_for(raw, zero=26, one=72), "DHT11_DECODE_OK", raw)
+
+    raw = frame_bytes(61, 0, 19, 2)
+    add("noisy_jitter", "+-8 us of ISR latency on every pulse",
+        edges_for(raw, jitter=8, rng=rng), "DHT11_DECODE_OK", raw)
+
+    raw = frame_bytes(80, 0, 5, 1)
+    add("noisy_slow_sensor", "Sensor at the edge of its tolerances: 58 us lows, 22/78 us highs",
+        edges_for(raw, low=58, zero=22, one=78, jitter=4, rng=rng), "DHT11_DECODE_OK", raw)
+
+    raw = frame_bytes(52, 0, 31, 0)
+    add("good_timer_wrap", "32-bit esp_timer wrap in the middle of the frame",
+        edges_for(raw, start=0xFFFFFFFF - 1500), "DHT11_DECODE_OK", raw)
+
+    raw = frame_bytes(40, 0, 22, 0)
+    add("truncated", "Capture timed out after 60 edges",
+        edges_for(raw)[:60], "DHT11_DECODE_TRUNCATED")
+
+    edges = edges_for(raw)
+    del edges[40]
+    add("lost_edge", "One edge missed: the merged pulse still fits, the bits shift",
+        edges, "DHT11_DECODE_CHECKSUM")
+
+    # Edge FIRST_DATA_EDGE + 2 * bit + 1 starts the high pulse of a bit; losing
+    # it merges that bit's low and high into one pulse
+    slow = dict(low=58, zero=22, one=78)
+    edges = edges_for(raw, **slow)
+    one_bit = next(b for b in range(8, FRAME_BITS) if (raw[b // 8] >> (7 - b % 8)) & 1)
+    del edges[FIRST_DATA_EDGE + 2 * one_bit + 1]
+    add("lost_edge_slow", "Slow sensor and one edge missed: a 58 + 78 us pulse",
+        edges, "DHT11_DECODE_BAD_PULSE")
+
+    edges = edges_for(raw)
+    spike = edges[20] + 10
+    edges[21:21] = [spike, spike + 2]
+    add("glitch", "2 us spike inside a high pulse shifts the bit alignment",
+        edges, "DHT11_DECODE_CHECKSUM")
+
+    bad = list(raw)
+    bad[4] ^= 0x01
+    add("bad_checksum", "Last checksum bit flipped on the wire",
+        edges_for(bad), "DHT11_DECODE_CHECKSUM", bad)
+
+    return captures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    lines = [
+        "// Generated by tools/dht11_corpus.py - do not edit",
+        "#ifndef DHT11_CORPUS_H",
+        "#define DHT11_CORPUS_H",
+        "",
+        "#include <stdint.h>",
+        "#include <stddef.h>",
+        '#include "dht11_decoder.h"',
+        "",
+        "typedef struct",
+        "{",
+        "    const char *name;",
+        "    const uint32_t *edges_us;",
+        "    size_t edge_count;",
+        "    dht11_decode_status_t status;",
+        "    uint8_t raw[5];             /**< expected bytes when the frame is complete */",
+        "} dht11_capture_t;",
+        "",
+    ]
+    captures = build()
+    for name, comment, edges, _, _ in captures:
+        lines.append("/* %s */" % comment)
+        lines.append("static const uint32_t %s_edges[] = {" % name)
+        for i in range(0, len(edges), 8):
+            lines.append("    " + ", ".join("%uu" % e for e in edges[i:i + 8]) + ",")
+        lines.append("};")
+        lines.append("")
+    lines.append("static const dht11_capture_t dht11_corpus[] = {")
+    for name, _, edges, status, raw in captures:
+        raw_text = ", ".join(str(b) for b in (raw or [0] * 5))
+        lines.append('    { "%s", %s_edges, %d, %s, { %s } },' % (name, name, len(edges), status, raw_text))
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif")
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+"""Comprime un recurso web para incrustarlo en el firmware.
+
+Lo invoca src/CMakeLists.txt al configurar el proyecto (y de nuevo cada
+vez que cambia el original). La salida es reproducible (sin nombre ni fecha en la cabecera
+gzip), así que el ETag que calcula el servidor solo cambia si cambia el
+contenido.
+
+Uso:
+    gzip_asset.py web/index.html web/dist/index.html.gz
+"""
+
+import argparse
+import gzip
+import os
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source")
+    parser.add_argument("output")
+    args = parser.parse_args()
+
+    with open(args.source, "rb") as f:
+        data = f.read()
+    packed = gzip.compress(data, compresslevel=9, mtime=0)
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "wb") as f:
+        f.write(packed)
+
+    print(f"{args.source}: {len(data)} -> {len(packed)} bytes", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
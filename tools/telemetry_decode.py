@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Decodifica los mensajes de telemetría publicados por el ESP32-C3.
+
+Acepta tanto el formato JSON como el CBOR compacto (ver include/telemetry.h)
+y devuelve siempre la misma estructura: una lista de muestras con nombres de
+campo y temperatura/humedad en grados/porcentaje.
+
+Uso:
+    telemetry_decode.py archivo.bin        # payload guardado en disco
+    telemetry_decode.py --hex 9fa900...    # payload en hexadecimal
+    mosquitto_sub -t test/server -N | telemetry_decode.py   # stdin
+
+Solo usa la biblioteca estándar para poder importarlo en la ingesta
+(decode_payload()).
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+# Debe coincidir con telemetry_key_t en include/telemetry.h
+KEYS = {
+    0: "ts",
+    1: "led",
+    2: "button",
+    3: "presses",
+    4: "temperature",
+    5: "humidity",
+    6: "sensor_valid",
+    7: "seq",
+    8: "reason",
+}
+FIXED_POINT_X10 = {"temperature", "humidity"}
+REASON_HEARTBEAT = -1
+
+_BREAK = object()
+
+
+class CborError(ValueError):
+    pass
+
+
+class _Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise CborError("payload truncado")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def argument(self, info):
+        if info < 24:
+            return info
+        if info == 24:
+            return self.take(1)[0]
+        if info == 25:
+            return struct.unpack(">H", self.take(2))[0]
+        if info == 26:
+            return struct.unpack(">I", self.take(4))[0]
+        if info == 27:
+            return struct.unpack(">Q", self.take(8))[0]
+        if info == 31:
+            return None  # longitud indefinida
+        raise CborError("argumento inválido %d" % info)
+
+    def item(self):
+        ib = self.take(1)[0]
+        major, info = ib >> 5, ib & 0x1F
+        if ib == 0xFF:
+            return _BREAK
+        arg = self.argument(info)
+        if major == 0:
+            return arg
+        if major == 1:
+            return -1 - arg
+        if major in (2, 3):
+            if arg is None:
+                raise CborError("cadenas indefinidas no soportadas")
+            raw = self.take(arg)
+            return raw if major == 2 else raw.decode("utf-8")
+        if major == 4:
+            out = []
+            while arg is None or len(out) < arg:
+                value = self.item()
+                if value is _BREAK:
+                    if arg is not None:
+                        raise CborError("break inesperado")
+                    break
+                out.append(value)
+            return out
+        if major == 5:
+            out = {}
+            while arg is None or len(out) < arg:
+                key = self.item()
+                if key is _BREAK:
+                    if arg is not None:
+                        raise CborError("break inesperado")
+                    break
+                out[key] = self.item()
+            return out
+        if major == 7:
+            if info == 20:
+                return False
+            if info == 21:
+                return True
+            if info in (22, 23):
+                return None
+            if info == 25:
+                return _half_to_float(arg)
+            if info == 26:
+                return struct.unpack(">f", struct.pack(">I", arg))[0]
+            if info == 27:
+                return struct.unpack(">d", struct.pack(">Q", arg))[0]
+        raise CborError("tipo CBOR no soportado 0x%02x" % ib)
+
+
+def _half_to_float(h):
+    return struct.unpack(">e", struct.pack(">H", h))[0]
+
+
+def cbor_loads(data):
+    reader = _Reader(bytes(data))
+    value = reader.item()
+    if value is _BREAK:
+        raise CborError("break inesperado")
+    if reader.pos != len(reader.data):
+        raise CborError("%d bytes sobrantes" % (len(reader.data) - reader.pos))
+    return value
+
+
+def _normalize_cbor_sample(raw):
+    sample = {}
+    for key, value in raw.items():
+        name = KEYS.get(key, str(key))
+        if name in FIXED_POINT_X10:
+            value = value / 10.0
+        elif name == "sensor_valid":
+            value = int(bool(value))
+        elif name == "reason":
+            value = "heartbeat" if value == REASON_HEARTBEAT else KEYS.get(value, str(value))
+        sample[name] = value
+    return sample
+
+
+def decode_payload(payload):
+    """Devuelve la lista de muestras de un mensaje (lote o muestra suelta)."""
+    payload = bytes(payload)
+    if payload[:1] in (b"{", b"["):
+        decoded = json.loads(payload.decode("utf-8"))
+        return decoded if isinstance(decoded, list) else [decoded]
+    decoded = cbor_loads(payload)
+    items = decoded if isinstance(decoded, list) else [decoded]
+    return [_normalize_cbor_sample(item) for item in items]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("file", nargs="?", help="payload binario (por defecto stdin)")
+    parser.add_argument("--hex", help="payload en hexadecimal")
+    args = parser.parse_args()
+
+    if args.hex:
+        payload = bytes.fromhex(args.hex)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            payload = f.read()
+    else:
+        payload = sys.stdin.buffer.read()
+
+    for sample in decode_payload(payload):
+        print(json.dumps(sample, ensure_ascii=False))
+
+
+if __name__ == "__main__":
+    main()